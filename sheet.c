@@ -8,53 +8,593 @@ Program to process tables from standard input and outputs it to standard output
 */
 
 #define DEBUG
+#define _POSIX_C_SOURCE 200809L
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <float.h>
+#include <stdint.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define X86_SIMD
+#endif
 
-#define MAX_CELL_LEN 100
-#define MAX_LINE_LEN 10240
+// Buffers of line are allocated from arena of line, arena gets new block of at least this size when it is full
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGNMENT 8
+// Minimal free space in edit buffer and index of delims when they are allocated
+#define MIN_LINE_GAP 64
+// Length of the longest formated number (%lf of largest double)
+#define MAX_NUMBER_LEN 320
+// Size of buffer for formated output, longer output is formated to allocated buffer
+#define PRINT_BUFFER_SIZE 1024
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+#define ERROR_MESSAGE_LEN 512
+// Input is split to chunks of whole lines with about this size for processing in threads
+#ifndef CHUNK_SIZE
+#define CHUNK_SIZE (1 << 20)
+#endif
+// Number of chunks that can be read ahead for each thread
+#define CHUNKS_PER_THREAD 2
+#define MAX_THREADS 256
+// Waiting for ring buffer first spins, then yields and then sleeps
+#define BACKOFF_SPINS 64
+#define BACKOFF_SLEEP_NS 50000
+#define CACHE_LINE_SIZE 64
+// Maximum number of other delims that are compared in SIMD registers, more delims are handled by lookup table
+#define MAX_SIMD_OTHER_DELIMS 8
+// Limits of regex of matches selector, lazily built DFA is flushed when it reaches MAX_DFA_STATES
+#define MAX_REGEX_STATES 10000
+#define MAX_REGEX_REPEAT 255
+#define MAX_REGEX_DEPTH 1000
+#define MAX_DFA_STATES 2048
+#define DFA_TABLE_SIZE (2 * MAX_DFA_STATES)
+// Output of each file of batch (sheet [commands] -- file1 file2 ...) is written next to it with this suffix
+#define OUTPUT_FILE_SUFFIX ".out"
+#define BATCH_SEPARATOR "--"
+// Groups of groupby are spilled to partition files when their table uses more memory than limit (--group-memory MB)
+#define DEFAULT_GROUP_MEMORY_MB 256
+#define MIN_GROUP_SLOTS 1024
+#define NUM_OF_SPILL_PARTITIONS 16
+// Each level of spilling splits partition by next bits of hash of key, partitions of last level are not spilled again
+#define SPILL_PARTITION_BITS 4
+#define MAX_SPILL_DEPTH 8
 
 const char *TABLE_COMS[] = {"irow", "arow", "drow", "drows", "icol", "acol", "dcol", "dcols"};
+const int TABLE_COMS_OPERANDS[] = {1, 0, 1, 2, 1, 0, 1, 2};
 #define NUMBER_OF_TABLE_COMS 8
 const char *DATA_COMS[] = {"cset", "tolower", "toupper", "round", "int", "copy", "swap", "move", "csum", "cavg", "cmin", "cmax", "ccount", "cseq"};
+const int DATA_COMS_OPERANDS[] = {2, 1, 1, 1, 1, 2, 2, 2, 3, 3, 3, 3, 3, 3};
 #define NUMBER_OF_DATA_COMS 14
-const char *SELECTOR_COMS[] = {"rows", "beginswith", "contains"};
-#define NUMBER_OF_SELECTOR_COMS 3
-
-enum OperatingMode {PASS, TABLE_EDIT, DATA_EDIT};
-enum ErrorCodes {NO_ERROR, MAX_LINE_LEN_EXCEDED, MAX_CELL_LEN_EXCEDED, INPUT_ERROR};
+const char *SELECTOR_COMS[] = {"rows", "beginswith", "contains", "containsany", "matches"};
+#define NUMBER_OF_SELECTOR_COMS 5
+// Every selector has two operands (column or row range and string)
+#define SELECTOR_OPERANDS 2
+// Aggregates of groupby K (index of aggregate is its MultiCellFunction)
+#define GROUP_BY_COM "groupby"
+const char *GROUP_COMS[] = {"sum", "min", "max", "avg", "count"};
+#define NUMBER_OF_GROUP_COMS 5
+// Options followed by value, value of option is never separator of batch
+const char *VALUE_OPTIONS[] = {"-d", "-f", "-j", "--byte-range", "--row-offset", "--group-memory"};
+#define NUMBER_OF_VALUE_OPTIONS 6
+
+// Powers of ten that are exactly representable in double
+const double EXACT_POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+#define MAX_EXACT_POWER_OF_TEN 22
+// Maximal integer that is exactly representable in double
+#define MAX_EXACT_DOUBLE_INT (1ULL << 53)
+// Number of decimal places of formated non integer values (same as %lf)
+#define FORMAT_DECIMALS 6
+#define FORMAT_DECIMALS_SCALE 1000000ULL
+
+enum OperatingMode {PASS, TABLE_EDIT, DATA_EDIT, COLUMN_STATS, GROUP_BY};
+enum CellTypes {CELL_STRING, CELL_NUMBER, CELL_EMPTY};
+// Length of lines and cells is not limited, MAX_LINE_LEN_EXCEDED is returned when line cant be stored in memory
+// and MAX_CELL_LEN_EXCEDED is not used anymore, codes are kept so exit codes dont change
+enum ErrorCodes {NO_ERROR, MAX_LINE_LEN_EXCEDED, MAX_CELL_LEN_EXCEDED, INPUT_ERROR, OUTPUT_ERROR};
 enum SingleCellFunction {UPPER, LOWER, ROUND, INT};
 enum MultiCellFunction {SUM, MIN, MAX, AVG, COUNT};
+enum RegexNodeType {REGEX_EMPTY, REGEX_BYTES, REGEX_CELL_START, REGEX_CELL_END, REGEX_CONCAT, REGEX_ALTERNATION, REGEX_REPEAT};
+enum RegexStateType {STATE_BYTES, STATE_SPLIT, STATE_CELL_START, STATE_CELL_END, STATE_MATCH};
+enum DfaStateFlags {DFA_MATCH = 1, DFA_MATCH_AT_END = 2};
+// Operators of selectors have types behind single selectors
+enum SelectorOperators {SELECTOR_AND = NUMBER_OF_SELECTOR_COMS, SELECTOR_OR, SELECTOR_NOT};
+
+typedef struct DelimSet DelimSet;
+typedef int (*DelimScanner)(char *string, int length, const DelimSet *delim_set, int normalize, int *positions);
+
+struct DelimSet
+{
+    // Main delim, other delims are replaced by it
+    char delim;
+    char others[256];
+    int num_of_others;
+    unsigned char is_other[256];
+
+    // Scanning function selected by supported instruction set
+    DelimScanner scan;
+};
+
+typedef struct
+{
+    // Node of parsed regex, concatenation and alternation have two children, repeat has only left child
+    int type;
+    int left, right;
+    // Number of repeats, max is -1 for unlimited
+    int min, max;
+    // Bitmap of bytes matched by REGEX_BYTES node
+    unsigned char bytes[32];
+} RegexNode;
+
+typedef struct
+{
+    // State of Thompson NFA, split continues to both next and alternative state
+    int type;
+    int next, alternative;
+    // Bitmap of bytes accepted by STATE_BYTES state
+    unsigned char bytes[32];
+} RegexState;
+
+typedef struct
+{
+    // Compiled regex is shared by all threads, each thread builds DFA from it in its own cache
+    RegexState *states;
+    int num_of_states;
+    int states_capacity;
+    int start;
+    // Bytes that are accepted by the same NFA states share class, one byte of each class represents it
+    unsigned char byte_classes[256];
+    unsigned char class_bytes[256];
+    int num_of_classes;
+    // Flag if regex matches empty cell, where cell start and cell end assertions pass at the same position
+    int matches_empty;
+    // Index of cache of regex in line
+    int id;
+} Regex;
+
+typedef struct
+{
+    // Lazily built DFA, transitions are computed from NFA when they are used first time
+    const Regex *regex;
+    // Row of transitions for each DFA state, -1 for transitions that are not computed yet
+    int *transitions;
+    char *flags;
+    int num_of_states;
+    // Initial state (cell start assertions are allowed only in it), -1 when its not built
+    int start_state;
+
+    // Sorted sets of NFA states of DFA states
+    int *sets;
+    size_t sets_length;
+    size_t sets_capacity;
+    size_t *set_starts;
+    int *set_lengths;
+    // Hash table of DFA states by their NFA sets
+    int *table;
+
+    // Work arrays for building new set of NFA states
+    int *set;
+    int set_length;
+    int *stack;
+    int *marks;
+    int mark;
+} RegexCache;
+
+typedef struct
+{
+    char *data;
+    size_t length;
+    size_t capacity;
+    // File descriptor where buffer is flushed when its full, buffer without file descriptor (-1) grows instead
+    int fd;
+    int error_flag;
+} OutputBuffer;
+
+typedef struct ArenaBlock
+{
+    struct ArenaBlock *previous;
+    size_t capacity;
+    size_t used;
+    char data[];
+} ArenaBlock;
+
+typedef struct
+{
+    // Block where memory is allocated, full blocks stay allocated until reset
+    ArenaBlock *current;
+    // Sum of capacities of all blocks
+    size_t capacity;
+} Arena;
+
+typedef struct
+{
+    // Generation of line content in which cell was parsed, value is valid only in the same generation
+    unsigned int generation;
+    int type;
+    double value;
+} CellValue;
 
 typedef struct
 {
+    // Range of cells and generation of line content for which aggregates were computed
+    int first_cell;
+    int last_cell;
+    unsigned int generation;
+    // Sum (in order of cells), minimum and maximum of number cells
+    double sum;
+    double min;
+    double max;
+    // Number of existing cells and number of non empty cells in range
+    int num_of_cells;
+    int num_of_nonempty;
+} RowAggregates;
+
+typedef struct
+{
+    // Number of number cells of column
+    long count;
+    // Sum with Neumaier compensation of rounding errors
+    double sum;
+    double compensation;
+    double min;
+    double max;
+    // Running mean and sum of squared differences from mean (Welford)
+    double mean;
+    double m2;
+} ColumnStats;
+
+typedef struct
+{
+    // Number of number cells and non empty cells of column in group
+    long count;
+    long nonempty;
+    double sum;
+    double min;
+    double max;
+} GroupValue;
+
+typedef struct
+{
+    // Key is stored in arena of table, its hash is kept so table can grow without hashing keys again
+    char *key;
+    int key_len;
+    uint64_t hash;
+    // Values of aggregated columns in order of aggregates
+    GroupValue *values;
+} Group;
+
+typedef struct
+{
+    // Groups in order of their first row, open addressing table of slots contains indexes of groups (-1 for empty slot)
+    Group *groups;
+    int num_of_groups;
+    int groups_capacity;
+    int *slots;
+    int num_of_slots;
+    // Keys and values of groups
+    Arena arena;
+    int num_of_values;
+    // Groups are spilled to partition files when memory of table exceeds limit, 0 when table is not initialized
+    size_t memory_limit;
+    // Level of spilling, partition is chosen by bits of hash that previous levels didnt use
+    int depth;
+    int spilled;
+    FILE *partitions[NUM_OF_SPILL_PARTITIONS];
+} GroupTable;
+
+typedef struct
+{
+    // Content of line that is not edited, points to input data (or its copy in arena when other delims are replaced)
     char *line_string;
-    char unedited_line_string[MAX_LINE_LEN + 2];
+    // Flag if content of line was moved to edit buffer
+    int edited;
+    // Edit buffer is gap buffer, content of edited line is text before gap and text after gap
+    // Edits only move text between gap and place of edit, buffer is replaced by larger one when gap is too small
+    char *edit_buffer;
+    int edit_capacity;
+    int gap_start;
+    int gap_end;
+    // Line as it was loaded from input (not copied)
+    char *unedited_line_string;
+    int unedited_line_len;
     char delim;
+    const DelimSet *delim_set;
+    // Flag if other delims in line string are already replaced by main delim
+    int normalized;
     int line_index;
 
-    // Reference number of cols
+    // Length of line string
+    int line_len;
+    // Positions of delims in line string, built on first use and kept in sync with every edit of line
+    // Index has its own gap at the same place as the edit buffer, positions after it are positions in edit buffer (behind the gap)
+    int *delim_positions;
+    int delims_capacity;
+    int delims_gap_start;
+    int delims_gap_end;
+    // -1 when index is not built yet
+    int num_of_delims;
+
+    // Reference number of cols, -1 until it is taken from first line
     int num_of_cols;
     // Number of cols after editing
     int final_cols;
 
+    // Buffer where printed lines are collected
+    OutputBuffer *output;
+
     int last_line_flag;
     int deleted;
+    int row_inserted;
     int process_flag;
     int error_flag;
+    // Error messages are collected and printed by caller, so worker threads dont print messages of discarded lines
+    char error_message[ERROR_MESSAGE_LEN];
+
+    // DFA caches of regexes (indexed by id of regex), each thread has its own line so caches are not shared
+    RegexCache **regex_caches;
+    int num_of_regex_caches;
+
+    // Memory of edit buffer, index of delims and copies of cells, all of it is released when next row is loaded
+    Arena arena;
+
+    // Parsed values of cells by index of cell, filled on first use
+    // New generation invalidates all values when content of line is replaced or cells are shifted
+    CellValue *cell_values;
+    int cell_values_capacity;
+    unsigned int generation;
+    // All aggregates of last processed range of cells, following commands over same range reuse them
+    RowAggregates aggregates;
+    // Flag if numbers of range are collected for vector kernel, only when program has more aggregate commands
+    int vector_aggregates;
+
+    // Statistics of columns over selected rows (--colstats), allocated on first selected row
+    ColumnStats *column_stats;
+    int num_of_stats_columns;
+
+    // Groups of selected rows (groupby), initialized on first selected row
+    GroupTable groups;
 } Line;
 
 typedef struct
+{
+    // Aho-Corasick automaton converted to DFA, every state has transition for every byte class
+    int *transitions;
+    // Flag of states where some pattern ends (pattern itself or its suffix)
+    char *matches;
+    int num_of_states;
+    int states_capacity;
+    // Bytes that are not in any pattern share class 0, other bytes have their own class
+    unsigned char byte_classes[256];
+    int num_of_classes;
+} Automaton;
+
+typedef struct Searcher Searcher;
+typedef int (*SubstringSearcher)(const char *string, int length, const Searcher *searcher);
+
+struct Searcher
+{
+    // Searched string is preprocessed once when selector is loaded
+    const char *needle;
+    int needle_len;
+    // Critical factorization of needle for Two-Way search, needle is periodic when its left part repeats with period
+    int critical_position;
+    int period;
+    int periodic;
+    // Automaton for set of searched strings (NULL for single string)
+    Automaton *automaton;
+    // Searching function selected by length of needle and supported instruction set
+    SubstringSearcher search;
+};
+
+typedef struct Selector
 {
     int selector_type;
     char *a1, *a2, *str;
     int ai1, ai2;
+    // Searcher for string of contains selector
+    Searcher searcher;
+    // Compiled regex of matches selector
+    Regex *regex;
+    // Operands of not (only left), and, or
+    struct Selector *left, *right;
 } Selector;
 
+typedef struct
+{
+    // Index of command in TABLE_COMS or DATA_COMS
+    int com_index;
+    // Numeric arguments converted from strings
+    int args[3];
+    // String argument (cset)
+    char *str;
+} Command;
+
+typedef struct
+{
+    int operating_mode;
+    Command *commands;
+    int num_of_commands;
+    // Number of arow commands, rows are appended after last line
+    int num_of_appended_rows;
+    // Largest row index of irow commands, 0 if there is none
+    int last_inserted_row;
+    // Index of first row after which all rows are printed unchanged (INT_MAX if there is none)
+    int first_passed_row;
+    // Number of commands computing aggregates of cells (csum, cavg, cmin, cmax, ccount)
+    int num_of_aggregates;
+    // Key column of groupby (commands are its aggregates) and memory limit of its groups
+    int group_column;
+    size_t group_memory_limit;
+} Program;
+
+typedef struct
+{
+    // Memory mapped input file
+    int file_input;
+    char *data;
+    size_t size;
+    size_t position;
+    // Only lines that start before this position are read (byte range)
+    size_t range_end;
+
+    // Buffers for reading from stdin (grown by getline), line stays valid until next line is read
+    char *buffers[2];
+    size_t buffer_sizes[2];
+    int current_buffer;
+
+    // Start of next chunk read from stdin that was read together with previous chunk
+    char *carry;
+    size_t carry_length;
+    size_t carry_capacity;
+    int end_of_input;
+} InputReader;
+
+typedef struct
+{
+    // Whole lines of input, chunk ends after new line character except last chunk of input
+    char *data;
+    size_t size;
+    int last_chunk;
+    // Buffer for data read from stdin
+    char *buffer;
+    size_t buffer_capacity;
+    // Global index of first line of chunk
+    int first_line_index;
+
+    // Processed lines of chunk
+    OutputBuffer output;
+    // Number of cols of last processed line
+    int final_cols;
+    int error_flag;
+    char error_message[ERROR_MESSAGE_LEN];
+    // Order of chunk in input
+    long sequence;
+} Chunk;
+
+typedef struct
+{
+    // Sequence number says if cell is ready for push (same as position) or pop (position + 1)
+    size_t sequence;
+    int value;
+} RingCell;
+
+typedef struct
+{
+    // Bounded lock-free queue, any number of threads can push and pop
+    RingCell *cells;
+    size_t mask;
+    // Positions are on separate cache lines so producers and consumers dont share them
+    char padding1[CACHE_LINE_SIZE];
+    size_t push_position;
+    char padding2[CACHE_LINE_SIZE];
+    size_t pop_position;
+    char padding3[CACHE_LINE_SIZE];
+} RingBuffer;
+
+typedef struct WorkerPool WorkerPool;
+
+typedef struct
+{
+    WorkerPool *pool;
+    int id;
+    // Each worker has its own line structure
+    Line *line;
+    pthread_t thread;
+
+    // Chunks assigned to worker, idle workers steal chunks from queues of other workers
+    RingBuffer tasks;
+    // Bytes of chunks in queue, reader assigns new chunk to worker with least bytes to process
+    size_t queued_bytes;
+    char padding[CACHE_LINE_SIZE];
+
+    // Statistics of worker
+    long num_of_chunks;
+    long num_of_stolen;
+    size_t processed_bytes;
+    double busy_time;
+} Worker;
+
+struct WorkerPool
+{
+    // Chunks are passed between threads by slot indexes:
+    // free slots from writer to reader, read chunks from reader to queues of workers, processed chunks from workers to writer
+    Chunk *chunks;
+    int num_of_slots;
+    RingBuffer free_chunks;
+    RingBuffer processed_chunks;
+    Worker *workers;
+    int num_of_workers;
+
+    // Reader state, number of chunks and error are valid when reader_done is set
+    InputReader *reader;
+    int reader_done;
+    long num_of_chunks;
+    int reader_error;
+    // Sequence number of first chunk with error, chunks after it are not processed
+    long error_sequence;
+    // Set by writer when processing ends
+    int stop;
+
+    // Shared state of processing, workers only read it
+    const Program *program;
+    Selector *selector;
+    // Settings of line (delims) and reference number of cols found by reader
+    const Line *line_settings;
+    int num_of_cols;
+
+    // Statistics of reading
+    size_t read_bytes;
+};
+
+typedef struct
+{
+    // Input files of batch, output of each file is written to file with OUTPUT_FILE_SUFFIX
+    char **files;
+    int num_of_files;
+    // Index of next file that is not taken by any thread
+    int next_file;
+    // Error code of every file, exit code is taken from first file with error
+    int *results;
+
+    // Commands are compiled once for all files, threads only read them
+    const Program *program;
+    Selector *selector;
+    const DelimSet *delim_set;
+    // Command arguments printed in debug output of each file
+    int argc;
+    char **argv;
+} Batch;
+
+typedef struct
+{
+    Batch *batch;
+    int id;
+    pthread_t thread;
+    // Each thread has its own line, reader and output buffer that are reused for all its files
+    Line *line;
+    InputReader *reader;
+    OutputBuffer output;
+
+    // Statistics of thread
+    long num_of_files;
+    size_t processed_bytes;
+    double busy_time;
+} BatchWorker;
+
 int round_double(double val)
 {
     /*
@@ -85,49 +625,6 @@ int strings_equal(const char *s1, const char *s2)
     return strcmp(s1, s2) == 0;
 }
 
-int string_start_with(const char *base_string, const char *start_string)
-{
-    /*
-     * Check if string starts with other string
-     *
-     * params:
-     * @base_string - string where to look for substring
-     * @start_string - substring to look for at start of base_string
-     *
-     * @return - 1 if base_string starts with start_string, 0 if dont
-     */
-
-    if (strlen(start_string) > strlen(base_string))
-        return 0;
-
-    return strncmp(start_string, base_string, strlen(start_string)) == 0;
-}
-
-int chck_args(int argc, char **argv)
-{
-    /*
-     * Check if lenght of every single argument is in limit
-     *
-     * params:
-     * @argc - length of argument array
-     * @argv - array of arguments
-     *
-     * @return - NO_ERROR if all arguments are in length limits
-     *         - MAX_CELL_LEN_EXCEDED if some argument is longer
-     */
-
-    for (int i = 1; i < argc; i++)
-    {
-        if (strlen(argv[i]) > MAX_CELL_LEN)
-        {
-            fprintf(stderr, "Argument %d exceded maximum allowed size! Maximum size is %d characters\n", i, MAX_CELL_LEN);
-            return MAX_CELL_LEN_EXCEDED;
-        }
-    }
-
-    return NO_ERROR;
-}
-
 // command_selectors
 /*
  * Selectors that will return index of command from arrays of commands
@@ -162,6 +659,18 @@ int get_data_com_index(char *com)
     }
     return -1;
 }
+
+int get_group_com_index(char *com)
+{
+    for (int i = 0; i < NUMBER_OF_GROUP_COMS; i++)
+    {
+        if (strings_equal(com, GROUP_COMS[i]))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
 // command_selectors
 
 int get_op_mode(char **input_array, int array_len)
@@ -195,19 +704,59 @@ int get_op_mode(char **input_array, int array_len)
     return PASS;
 }
 
-void rm_newline_chars(char *s) {
+int rm_newline_chars(char *s) {
     /*
      * Function to remove new line characters
      * Iterate over string until it new line character then replace it with 0
      *
      * params:
      * @s - pointer to string (char array)
+     *
+     * @return - length of string without new line characters
+     */
+
+    int length = 0;
+    while(s[length] && s[length] != '\n' && s[length] != '\r')
+        length++;
+
+    s[length] = 0;
+    return length;
+}
+
+int split_next_line(char *data, size_t size, size_t *position, char **line, int *length)
+{
+    /*
+     * Take next line from block of input data without new line characters
+     *
+     * params:
+     * @data - block of input data
+     * @size - size of block
+     * @position - position of next line in block, moved behind the taken line
+     * @line - output pointer to start of line (line is not terminated)
+     * @length - output length of line
+     *
+     * @return - 1 if line was taken
+     *         - 0 on end of block
      */
 
-    while(*s && *s != '\n' && *s != '\r')
-        s++;
+    if (*position >= size)
+        return 0;
+
+    char *start = data + *position;
+    size_t rest = size - *position;
+    char *end = memchr(start, '\n', rest);
+
+    size_t line_length = end == NULL ? rest : (size_t)(end - start);
+    *position += end == NULL ? rest : line_length + 1;
 
-    *s = 0;
+    // Same as for stdin everything after carriage return is ignored
+    char *carriage_return = memchr(start, '\r', line_length);
+    if (carriage_return != NULL)
+        line_length = carriage_return - start;
+
+    *line = start;
+    *length = (int)line_length;
+    return 1;
 }
 
 char *get_opt(int argc, char *argv[], char *opt_flag)
@@ -241,1603 +790,7752 @@ char *get_opt(int argc, char *argv[], char *opt_flag)
     return NULL;
 }
 
-char *get_delims(char *input_array[], int array_len)
+int has_flag(int argc, char *argv[], char *flag)
 {
     /*
-     * Get delims for current input data
+     * Check if flag without value is in arguments
      *
      * params:
-     * @input_array - array of strings (args)
-     * @array_len - number of args
+     * @argc - number of arguments
+     * @argv - array of arguments
+     * @flag - flag to look for
      *
-     * @return - Array of delim chars to use
+     * @return - 1 if flag is found
+     *         - 0 if not
      */
 
-    char *arg_delims = get_opt(array_len, input_array, "-d");
-    return arg_delims == NULL ? " " : arg_delims;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strings_equal(argv[i], flag))
+            return 1;
+    }
+
+    return 0;
 }
 
-void normalize_delims(char *string, const char* delims)
+int get_number_of_operands(char *arg)
 {
     /*
-     * Iterate over string and replace delims that are not on 0 position in delims string with delim on 0 position
+     * Get number of arguments that belong to command, selector or option
      *
      * params:
-     * @string - string where to replace delims
-     * @delims - string with delims
+     * @arg - argument
+     *
+     * @return - number of following arguments that are operands of arg (0 for other arguments)
      */
 
-    for (size_t i = 0; string[i]; i++)
+    int com_index = get_table_com_index(arg);
+    if (com_index >= 0)
+        return TABLE_COMS_OPERANDS[com_index];
+
+    if ((com_index = get_data_com_index(arg)) >= 0)
+        return DATA_COMS_OPERANDS[com_index];
+
+    // Key column of groupby and column of its aggregates
+    if (strings_equal(arg, GROUP_BY_COM) || get_group_com_index(arg) >= 0)
+        return 1;
+
+    for (int i = 0; i < NUMBER_OF_SELECTOR_COMS; i++)
     {
-        for (size_t j = 1; delims[j]; j++)
-        {
-            // Ignore duplicates of first delim
-            if (delims[j] == delims[0])
-                continue;
+        if (strings_equal(arg, SELECTOR_COMS[i]))
+            return SELECTOR_OPERANDS;
+    }
 
-            if (string[i] == delims[j])
-            {
-                string[i] = delims[0];
-            }
-        }
+    for (int i = 0; i < NUMBER_OF_VALUE_OPTIONS; i++)
+    {
+        if (strings_equal(arg, VALUE_OPTIONS[i]))
+            return 1;
     }
+
+    return 0;
 }
 
-int count_specific_chars(const char *string, char ch)
+int find_argument(int argc, char *argv[], char *arg)
 {
     /*
-     * Count number of specific characters in string
+     * Find argument that is command, selector or option and not operand of other one
+     * Operands are skipped, so string argument of command (cset 1 groupby) isnt found
      *
      * params:
-     * @string - input string where count chars
-     * @ch - char we want to count
+     * @argc - number of arguments
+     * @argv - array of arguments
+     * @arg - argument to look for
      *
-     * @return - number of chars we found
+     * @return - index of argument
+     *         - -1 if it is not found
      */
 
-    int delim_counter = 0;
-    for (size_t i = 0; string[i]; i++)
+    for (int i = 1; i < argc; i += 1 + get_number_of_operands(argv[i]))
     {
-        if (string[i] == ch) delim_counter++;
+        if (strings_equal(argv[i], arg))
+            return i;
     }
 
-    return delim_counter;
+    return -1;
 }
 
-int get_number_of_cells(Line *line)
+char *get_delims(char *input_array[], int array_len)
 {
     /*
-     * Get number of cells in row
-     * Cell is substring separated by deliminator
+     * Get delims for current input data
      *
      * params:
-     * @line - structure with line data
+     * @input_array - array of strings (args)
+     * @array_len - number of args
+     *
+     * @return - Array of delim chars to use
      */
 
-    return count_specific_chars(line->line_string, line->delim) + 1;
+    char *arg_delims = get_opt(array_len, input_array, "-d");
+    return arg_delims == NULL ? " " : arg_delims;
 }
 
-int get_position_of_character(char *string, char ch, int index)
+int scan_delims_scalar_from(char *string, int start, int length, const DelimSet *delim_set, int normalize, int *positions, int count)
 {
     /*
-     * Get position of character of certain index in string
+     * Scalar part of delim scanning, used for rest of string after SIMD blocks
      *
      * params:
-     * @string - string where to find delims
-     * @ch - character we are looking for
-     * @index - index of occurence of character in string
+     * @string - string to scan
+     * @start - index of first char to scan
+     * @length - length of string
+     * @delim_set - structure with delims
+     * @normalize - flag if other delims should be replaced by main delim
+     * @positions - output array for positions of delims (NULL if not wanted)
+     * @count - number of positions already saved in array
      *
-     * @return - 0 if character position found else -1
+     * @return - number of saved positions
      */
 
-    if (index > (count_specific_chars(string, ch) - 1) || index < 0) return -1;
+    for (int i = start; i < length; i++)
+    {
+        if (normalize && delim_set->is_other[(unsigned char)string[i]])
+            string[i] = delim_set->delim;
 
-    int delim_counter = 0;
-    for (size_t i = 0; string[i]; i++)
+        if (positions != NULL && string[i] == delim_set->delim)
+            positions[count++] = i;
+    }
+
+    return count;
+}
+
+int scan_delims_scalar(char *string, int length, const DelimSet *delim_set, int normalize, int *positions)
+{
+    return scan_delims_scalar_from(string, 0, length, delim_set, normalize, positions, 0);
+}
+
+#ifdef X86_SIMD
+// delim_scanners
+/*
+ * SIMD versions of delim scanning, blocks of string are compared with all delims at once
+ * Blocks are written back only when there was some other delim replaced
+ *
+ * params:
+ * @string - string to scan
+ * @length - length of string
+ * @delim_set - structure with delims
+ * @normalize - flag if other delims should be replaced by main delim
+ * @positions - output array for positions of delims (NULL if not wanted)
+ *
+ * @return - number of saved positions
+ */
+
+__attribute__((target("sse2")))
+int scan_delims_sse2(char *string, int length, const DelimSet *delim_set, int normalize, int *positions)
+{
+    int num_of_others = normalize ? delim_set->num_of_others : 0;
+    if (num_of_others > MAX_SIMD_OTHER_DELIMS)
+        return scan_delims_scalar(string, length, delim_set, normalize, positions);
+
+    __m128i delim_block = _mm_set1_epi8(delim_set->delim);
+    __m128i other_blocks[MAX_SIMD_OTHER_DELIMS];
+    for (int j = 0; j < num_of_others; j++)
+        other_blocks[j] = _mm_set1_epi8(delim_set->others[j]);
+
+    int count = 0, i = 0;
+    for (; i + 16 <= length; i += 16)
     {
-        if (string[i] == ch)
+        __m128i block = _mm_loadu_si128((const __m128i *)(string + i));
+
+        if (num_of_others > 0)
+        {
+            __m128i other_mask = _mm_setzero_si128();
+            for (int j = 0; j < num_of_others; j++)
+                other_mask = _mm_or_si128(other_mask, _mm_cmpeq_epi8(block, other_blocks[j]));
+
+            if (_mm_movemask_epi8(other_mask))
+            {
+                block = _mm_or_si128(_mm_andnot_si128(other_mask, block), _mm_and_si128(other_mask, delim_block));
+                _mm_storeu_si128((__m128i *)(string + i), block);
+            }
+        }
+
+        if (positions != NULL)
         {
-            delim_counter++;
-            if ((delim_counter - 1) == index)
-                return i;
+            unsigned int bits = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(block, delim_block));
+            while (bits)
+            {
+                positions[count++] = i + __builtin_ctz(bits);
+                bits &= bits - 1;
+            }
         }
     }
 
-    return -1;
+    return scan_delims_scalar_from(string, i, length, delim_set, normalize, positions, count);
 }
 
-int get_start_of_substring(Line *line, int index)
+__attribute__((target("avx2")))
+int scan_delims_avx2(char *string, int length, const DelimSet *delim_set, int normalize, int *positions)
 {
-    /*
-     * Get start index of substring from line string limited by delim
-     *
-     * params:
-     * @line - structure with line data
-     * @index - index of substring in line
-     *
-     * @return - index of first char of substring if found
-     *         - -1 on error
-     */
+    int num_of_others = normalize ? delim_set->num_of_others : 0;
+    if (num_of_others > MAX_SIMD_OTHER_DELIMS)
+        return scan_delims_scalar(string, length, delim_set, normalize, positions);
 
-    if (index < 0 || index > line->final_cols)
-        return -1;
+    __m256i delim_block = _mm256_set1_epi8(delim_set->delim);
+    __m256i other_blocks[MAX_SIMD_OTHER_DELIMS];
+    for (int j = 0; j < num_of_others; j++)
+        other_blocks[j] = _mm256_set1_epi8(delim_set->others[j]);
 
-    if (index == 0)
+    int count = 0, i = 0;
+    for (; i + 32 <= length; i += 32)
     {
-        // if we want first substring there is no delim before substring then we are starting from first char of string
-        return 0;
-    }
-    else
-    {
-        // first character of substring after start delim
-        return get_position_of_character(line->line_string, line->delim, index - 1) + 1;
+        __m256i block = _mm256_loadu_si256((const __m256i *)(string + i));
+
+        if (num_of_others > 0)
+        {
+            __m256i other_mask = _mm256_setzero_si256();
+            for (int j = 0; j < num_of_others; j++)
+                other_mask = _mm256_or_si256(other_mask, _mm256_cmpeq_epi8(block, other_blocks[j]));
+
+            if (_mm256_movemask_epi8(other_mask))
+            {
+                block = _mm256_blendv_epi8(block, delim_block, other_mask);
+                _mm256_storeu_si256((__m256i *)(string + i), block);
+            }
+        }
+
+        if (positions != NULL)
+        {
+            unsigned int bits = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, delim_block));
+            while (bits)
+            {
+                positions[count++] = i + __builtin_ctz(bits);
+                bits &= bits - 1;
+            }
+        }
     }
+
+    // Clear upper halves of registers, otherwise following SSE code is slowed by transition penalty
+    _mm256_zeroupper();
+
+    return scan_delims_scalar_from(string, i, length, delim_set, normalize, positions, count);
 }
+// delim_scanners
+#endif
 
-int get_end_of_substring(Line *line, int index)
+void init_delim_set(DelimSet *delim_set, const char *delims)
 {
     /*
-     * Get last index of substring from line string limited by delim
+     * Prepare set of delims and select scanning function for current CPU
      *
      * params:
-     * @line - structure with line data
-     * @index - index of substring in line
-     *
-     * @return - index of last char of substring if found
-     *         - -1 on error
+     * @delim_set - structure to initialize
+     * @delims - string with delims, first one is main delim
      */
 
-    if (index > (line->final_cols - 1))
-        return -1;
+    delim_set->delim = delims[0];
+    delim_set->num_of_others = 0;
+    memset(delim_set->is_other, 0, sizeof(delim_set->is_other));
 
-    if (index >= (line->final_cols - 1))
+    for (size_t i = 1; delims[i]; i++)
     {
-        // if we are on the last cell we are going to the end of that line to the index of last char
-        return (int)strlen(line->line_string) - 1;
-    }
-    else
-    {
-        // last character of substring before delim
-        // position of delim - 1
-        return get_position_of_character(line->line_string, line->delim, index) - 1;
+        unsigned char ch = (unsigned char)delims[i];
+
+        // Ignore duplicates of first delim and duplicates of other delims
+        if (delims[i] == delims[0] || delim_set->is_other[ch])
+            continue;
+
+        delim_set->is_other[ch] = 1;
+        delim_set->others[delim_set->num_of_others++] = delims[i];
     }
+
+    delim_set->scan = scan_delims_scalar;
+
+#ifdef X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        delim_set->scan = scan_delims_avx2;
+    else if (__builtin_cpu_supports("sse2"))
+        delim_set->scan = scan_delims_sse2;
+#endif
 }
 
-int get_value_of_cell(Line *line, int index, char *substring)
-{
-    /*
-     * Extract value of cell
-     *
-     * params:
-     * @line - structure with line data
-     * @index - index of cell
-     * @substring - string for saving result
-     * @max_length - maximal length of one cell
-     *
-     * @return - 0 on success
-     *         - -1 on error
-     */
+// substring_searchers
+/*
+ * Search for needle of searcher in string that doesnt have to be terminated
+ *
+ * params:
+ * @string - string where to look for needle
+ * @length - length of string
+ * @searcher - structure with preprocessed needle
+ *
+ * @return - 1 if string contains needle
+ *         - 0 if not
+ */
 
-    // Check if index of cell is valid
-    if (index > (line->final_cols - 1) || index < 0)
-        return -1;
+int search_empty(const char *string, int length, const Searcher *searcher)
+{
+    (void)string;
+    (void)length;
+    (void)searcher;
 
-    // Get indexes of substring
-    int start_index = get_start_of_substring(line, index);
-    int end_index = get_end_of_substring(line, index);
+    // Empty string is contained in every string
+    return 1;
+}
 
-    // If both indexes are bad then its error
-    if (start_index < 0 && end_index < 0)
-        return -1;
+int search_char(const char *string, int length, const Searcher *searcher)
+{
+    return memchr(string, searcher->needle[0], length) != NULL;
+}
 
-    // if start index is 0 and end index is -1 it means its first cell in row and its empty
-    // then its not problem only it needs to set substring to empty string
-    if (start_index == 0 && end_index == -1)
+int search_two_way(const char *string, int length, const Searcher *searcher)
+{
+    // Right part of needle is compared from critical position, left part only when right part matches
+    // Shifts never skip occurrence, so string is searched in linear time for any needle
+    const unsigned char *needle = (const unsigned char *)searcher->needle;
+    const unsigned char *text = (const unsigned char *)string;
+    int needle_len = searcher->needle_len;
+    int critical = searcher->critical_position;
+    int period = searcher->period;
+    // Prefix of needle that is known to match after shift by period of periodic needle
+    int memory = -1;
+
+    for (int j = 0; j <= length - needle_len;)
     {
-        substring[0] = 0;
-        return 0;
-    }
+        int i = (critical > memory ? critical : memory) + 1;
+        while (i < needle_len && needle[i] == text[i + j])
+            i++;
 
-    // Return if length of substring is larger than maximum size of one cell
-    if ((end_index - start_index + 1) > MAX_CELL_LEN)
-    {
-        fprintf(stderr, "\nCell %d on line %d exceded max memory size! Max length of cell is %d characters (exclude delims)\n", index + 1, line->line_index + 1, MAX_CELL_LEN);
-        line->error_flag = MAX_CELL_LEN_EXCEDED;
-        return -1;
+        if (i < needle_len)
+        {
+            j += i - critical;
+            memory = -1;
+            continue;
+        }
+
+        i = critical;
+        while (i > memory && needle[i] == text[i + j])
+            i--;
+
+        if (i <= memory)
+            return 1;
+
+        j += period;
+        memory = searcher->periodic ? needle_len - period - 1 : -1;
     }
 
-    /*
-        for (int i=0; i < (MAX_CELL_LEN + 1) && start_index + i <= end_index; i++)
-            substring[i] = line->line_string[start_index+i];
-        substring[end_index-start_index+1] = '\0';
-     */
+    return 0;
+}
 
-    // Save wanted substring to substring array
-    int length = end_index - start_index + 1;
+int search_scalar_from(const char *string, int start, int length, const Searcher *searcher)
+{
+    // Candidates are found by first char of needle and only they are compared whole
+    // When compared candidates cost more than length of string, rest of string is searched by Two-Way
+    long work = 0;
+    int last_start = length - searcher->needle_len;
+    for (int i = start; i <= last_start; i++)
+    {
+        const char *candidate = memchr(string + i, searcher->needle[0], last_start - i + 1);
+        if (candidate == NULL)
+            return 0;
 
-    // Check if length is valid (only for case when the cell of inputed index doesnt exist)
-    if (length < 0)
-        return -1;
+        i = (int)(candidate - string);
+        if (memcmp(candidate + 1, searcher->needle + 1, searcher->needle_len - 1) == 0)
+            return 1;
 
-    strncpy(substring, &(line->line_string[start_index]), length);
+        work += searcher->needle_len;
+        if (work > length)
+            return search_two_way(string + i + 1, length - i - 1, searcher);
+    }
 
     return 0;
 }
 
-int check_line_sanity(Line *line)
+int search_scalar(const char *string, int length, const Searcher *searcher)
 {
-    /*
-     * Check if line is no longer than maximum allowed length of one line and
-     * check if each cell is not larger than maximum allowed length of one cell
-     *
-     * params:
-     * @line - structure with line data
-     *
-     * @return - 1 if line is ok
-     *         - 0 on fail
-     */
+    return search_scalar_from(string, 0, length, searcher);
+}
 
-    if (line->error_flag)
-        return 0;
+#ifdef X86_SIMD
+// Blocks of string are compared with first and last char of needle, middle of needle is compared only where both match
+__attribute__((target("sse2")))
+int search_sse2(const char *string, int length, const Searcher *searcher)
+{
+    int needle_len = searcher->needle_len;
+    __m128i first = _mm_set1_epi8(searcher->needle[0]);
+    __m128i last = _mm_set1_epi8(searcher->needle[needle_len - 1]);
 
-    if ((strlen(line->line_string) == MAX_LINE_LEN + 1) && (line->line_string[MAX_LINE_LEN + 1] != '\n'))
+    long work = 0;
+    int i = 0;
+    for (; i + needle_len - 1 + 16 <= length; i += 16)
     {
-        fprintf(stderr, "\nLine %d exceded max memory size! Max length of line is %d characters (including delims)\n", line->line_index+1, MAX_LINE_LEN);
-        line->error_flag = MAX_LINE_LEN_EXCEDED;
-        return 0;
-    }
+        __m128i block_first = _mm_loadu_si128((const __m128i *)(string + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i *)(string + i + needle_len - 1));
 
-    char cell_buff[MAX_CELL_LEN + 1];
-    int num_of_cells = get_number_of_cells(line);
+        unsigned int bits = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+                                                                           _mm_cmpeq_epi8(block_last, last)));
+        while (bits)
+        {
+            int position = i + __builtin_ctz(bits);
+            if (memcmp(string + position + 1, searcher->needle + 1, needle_len - 2) == 0)
+                return 1;
 
-    for (int i = 0; i < num_of_cells; i++)
-    {
-        get_value_of_cell(line, i, cell_buff);
-        if (line->error_flag)
-            return 0;
+            // Too many false candidates (long needle with repeated chars), rest is searched in linear time
+            work += needle_len;
+            if (work > length)
+                return search_two_way(string + position + 1, length - position - 1, searcher);
+
+            bits &= bits - 1;
+        }
     }
 
-    return 1;
+    return search_scalar_from(string, i, length, searcher);
 }
+#endif
+// substring_searchers
 
-int is_string_double(char *string)
+int get_maximal_suffix(const char *needle, int length, int reversed_order, int *period)
 {
     /*
-     * Check if input string is double
+     * Find start of lexicographically maximal suffix of needle and its period
      *
      * params:
-     * @string - string to convertion
+     * @needle - searched string
+     * @length - length of needle
+     * @reversed_order - flag to compare chars in reversed order
+     * @period - output period of suffix
      *
-     * @return - 1 if is double
-     *         - 0 if not
+     * @return - position before first char of maximal suffix
      */
 
-    if (string[0] == 0)
-        return 0;
+    const unsigned char *chars = (const unsigned char *)needle;
+    int suffix = -1;
+    int j = 0;
+    int k = 1;
+    *period = 1;
 
-    // Pointer to unprocessed part of string
-    char *rest;
-    strtod(string, &rest);
+    while (j + k < length)
+    {
+        unsigned char a = chars[j + k];
+        unsigned char b = chars[suffix + k];
 
-    if (rest[0] != 0)
-        return 0;
+        if (a == b)
+        {
+            // Suffix continues, whole period matched
+            if (k != *period)
+                k++;
+            else
+            {
+                j += *period;
+                k = 1;
+            }
+        }
+        else if ((a < b) != reversed_order)
+        {
+            j += k;
+            k = 1;
+            *period = j - suffix;
+        }
+        else
+        {
+            suffix = j;
+            j = suffix + 1;
+            k = 1;
+            *period = 1;
+        }
+    }
 
-    return 1;
+    return suffix;
 }
 
-int string_to_double(char *string, double *val)
+void init_two_way(Searcher *searcher)
 {
     /*
-     * Check if input string could be double and then convert it to double
+     * Compute critical factorization of needle for Two-Way search
      *
      * params:
-     * @string - string to convertion
-     * @val - output double value
-     *
-     * @return - 0 if conversion is success
-     *         - -1 if whole string is not double
+     * @searcher - structure with needle
      */
 
-    // we dont want to convert empty strings to 0
-    if (string[0] == 0)
-        return -1;
+    int period, reversed_period;
+    int suffix = get_maximal_suffix(searcher->needle, searcher->needle_len, 0, &period);
+    int reversed_suffix = get_maximal_suffix(searcher->needle, searcher->needle_len, 1, &reversed_period);
 
-    // Pointer to unprocessed part of string
-    char *rest;
-    (*val) = strtod(string, &rest);
+    // Later of both suffixes gives critical factorization
+    if (reversed_suffix > suffix)
+    {
+        suffix = reversed_suffix;
+        period = reversed_period;
+    }
 
-    // If rest of string is not empty then string cant be converted to double
-    if (rest[0] != 0)
-        return -1;
+    searcher->critical_position = suffix;
+    searcher->periodic = memcmp(searcher->needle, searcher->needle + period, (size_t)suffix + 1) == 0;
 
-    return 0;
+    // Period of non periodic needle is replaced by safe shift
+    if (!searcher->periodic)
+    {
+        int right_length = searcher->needle_len - suffix - 1;
+        period = (suffix + 1 > right_length ? suffix + 1 : right_length) + 1;
+    }
+
+    searcher->period = period;
 }
 
-int is_string_int(char *string)
+void init_searcher(Searcher *searcher, const char *needle)
 {
     /*
-     * Check if input string is intiger
+     * Preprocess needle and select searching function for it
      *
      * params:
-     * @string - string to convertion
-     *
-     * @return - 1 if is intiger
-     *         - 0 if not
+     * @searcher - structure to initialize
+     * @needle - searched string
      */
 
-    if (string[0] == 0)
-        return 0;
+    searcher->needle = needle;
+    searcher->needle_len = (int)strlen(needle);
+    searcher->automaton = NULL;
 
-    // Pointer to unprocessed part of string
-    char *rest;
-    strtol(string, &rest, 10);
+    if (searcher->needle_len == 0)
+    {
+        searcher->search = search_empty;
+        return;
+    }
 
-    if (rest[0] != 0)
-        return 0;
+    if (searcher->needle_len == 1)
+    {
+        searcher->search = search_char;
+        return;
+    }
 
-    return 1;
+    init_two_way(searcher);
+    searcher->search = search_scalar;
+
+#ifdef X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        searcher->search = search_sse2;
+#endif
 }
 
-int string_to_int(char *string, int *val)
+int add_automaton_state(Automaton *automaton)
 {
     /*
-     * Try to convert string to int
+     * Add state without transitions to automaton
      *
      * params:
-     * @string - string to convertion
-     * @val - output intiger value
+     * @automaton - structure with automaton data
      *
-     * @return - 0 if conversion is success
-     *         - -1 if whole string is not int
+     * @return - index of new state
+     *         - -1 if memory cant be allocated
      */
 
-    // we dont want to convert empty strings to 0
-    if (string[0] == 0)
-        return -1;
+    if (automaton->num_of_states == automaton->states_capacity)
+    {
+        int capacity = automaton->states_capacity * 2;
+        int *transitions = realloc(automaton->transitions, sizeof(int) * (size_t)capacity * automaton->num_of_classes);
+        if (transitions == NULL)
+            return -1;
 
-    // Pointer to unprocessed part of string
-    char *rest;
-    (*val) = (int)strtol(string, &rest, 10);
+        automaton->transitions = transitions;
 
-    // If rest of string is not empty then string cant be converted to int
-    if (rest[0] != 0)
-        return -1;
+        char *matches = realloc(automaton->matches, (size_t)capacity);
+        if (matches == NULL)
+            return -1;
 
-    return 0;
+        automaton->matches = matches;
+        automaton->states_capacity = capacity;
+    }
+
+    int state = automaton->num_of_states++;
+    int *row = &automaton->transitions[(size_t)state * automaton->num_of_classes];
+    for (int i = 0; i < automaton->num_of_classes; i++)
+        row[i] = -1;
+
+    automaton->matches[state] = 0;
+    return state;
 }
 
-int is_double_int(double val)
+int build_automaton(Automaton *automaton, char *patterns, size_t size)
 {
     /*
-     * Check if double could be converted to int without loss of precision
+     * Build automaton for patterns, every line of patterns is one pattern
+     * Empty lines are skipped
      *
      * params:
-     * @val - double value to check
+     * @automaton - structure to initialize
+     * @patterns - content of file with patterns
+     * @size - size of content
      *
-     * @return - 1 if it could be converted without loss of precision
-     *         - 0 if couldnt
+     * @return - NO_ERROR on success
+     *         - INPUT_ERROR if memory cant be allocated
      */
 
-    if (val == 0) return 1;
-    return (int)(val) == val;
-}
+    char *pattern;
+    int length;
+    size_t position = 0;
 
-void string_conversion(char *string, int conversion_flag)
-{
-    /*
-     * Converts string based on selected functions
-     * Supported functions: UPPER - string to uppercase
-     *                      LOWER - string to lowercase
-     *
-     * params:
-     * @string - input string
-     * @conversion_flag - flag to select function
-     */
+    // Classes of bytes from all patterns
+    memset(automaton->byte_classes, 0, sizeof(automaton->byte_classes));
+    automaton->num_of_classes = 1;
+    while (split_next_line(patterns, size, &position, &pattern, &length))
+    {
+        for (int i = 0; i < length; i++)
+        {
+            unsigned char ch = (unsigned char)pattern[i];
+            if (automaton->byte_classes[ch] == 0)
+                automaton->byte_classes[ch] = (unsigned char)automaton->num_of_classes++;
+        }
+    }
 
-    for (size_t i = 0; string[i]; i++)
+    automaton->num_of_states = 0;
+    automaton->states_capacity = 64;
+    automaton->transitions = malloc(sizeof(int) * (size_t)automaton->states_capacity * automaton->num_of_classes);
+    automaton->matches = malloc((size_t)automaton->states_capacity);
+    if (automaton->transitions == NULL || automaton->matches == NULL || add_automaton_state(automaton) < 0)
+        return INPUT_ERROR;
+
+    // Trie of patterns
+    position = 0;
+    while (split_next_line(patterns, size, &position, &pattern, &length))
     {
-        // iterate over string
-        while (*string)
+        if (length == 0)
+            continue;
+
+        int state = 0;
+        for (int i = 0; i < length; i++)
         {
-            if ((*string >= 'a' && *string <= 'z') || (*string >= 'A' && *string <= 'Z'))
+            int byte_class = automaton->byte_classes[(unsigned char)pattern[i]];
+            int next_state = automaton->transitions[(size_t)state * automaton->num_of_classes + byte_class];
+            if (next_state < 0)
             {
-                if (conversion_flag == UPPER)
-                    *string = (char)toupper(*string);
-                else if (conversion_flag == LOWER)
-                    *string = (char)tolower(*string);
+                if ((next_state = add_automaton_state(automaton)) < 0)
+                    return INPUT_ERROR;
+
+                automaton->transitions[(size_t)state * automaton->num_of_classes + byte_class] = next_state;
             }
 
-            string++;
+            state = next_state;
+        }
+
+        automaton->matches[state] = 1;
+    }
+
+    // Missing transitions are replaced by transitions of failure state, states are visited by depth
+    // so failure state (shorter suffix) has all transitions completed before
+    int *queue = malloc(sizeof(int) * (size_t)automaton->num_of_states);
+    int *failures = malloc(sizeof(int) * (size_t)automaton->num_of_states);
+    if (queue == NULL || failures == NULL)
+    {
+        free(queue);
+        free(failures);
+        return INPUT_ERROR;
+    }
+
+    int queue_start = 0, queue_end = 0;
+    queue[queue_end++] = 0;
+    failures[0] = 0;
+
+    while (queue_start < queue_end)
+    {
+        int state = queue[queue_start++];
+        int *row = &automaton->transitions[(size_t)state * automaton->num_of_classes];
+        int *failure_row = &automaton->transitions[(size_t)failures[state] * automaton->num_of_classes];
+
+        for (int i = 0; i < automaton->num_of_classes; i++)
+        {
+            if (row[i] < 0)
+            {
+                row[i] = state == 0 ? 0 : failure_row[i];
+                continue;
+            }
+
+            int next_state = row[i];
+            failures[next_state] = state == 0 ? 0 : failure_row[i];
+            automaton->matches[next_state] |= automaton->matches[failures[next_state]];
+            queue[queue_end++] = next_state;
         }
     }
+
+    free(queue);
+    free(failures);
+    return NO_ERROR;
 }
 
-int argument_to_int(char *input_array[], int array_len, int index)
+void free_automaton(Automaton *automaton)
 {
     /*
-     * Try to convert argument to int
+     * Release memory of automaton
      *
      * params:
-     * @input_array - array with all arguments
-     * @array_len - lenght of array with arguments
-     * @index - index of argument we want convert to int
-     *
-     * @return - int value of argument
-     *         - on error 0
+     * @automaton - structure with automaton data
      */
 
-    int val;
-
-    if (index >= array_len || string_to_int(input_array[index], &val) != 0)
-        return 0;
-
-    return val;
+    free(automaton->transitions);
+    free(automaton->matches);
+    automaton->transitions = NULL;
+    automaton->matches = NULL;
 }
 
-void generate_empty_row(Line *line)
+int search_automaton(const char *string, int length, const Searcher *searcher)
 {
     /*
-     * Create string with empty line format based on wanted line length and delim char
-     * Empty line is saved to line structure instead of current line string
-     * Line will have same number of cells as saved number of cells from first line
+     * Search for any pattern of automaton in string in one pass
      *
      * params:
-     * @line - structure with line data
+     * @string - string where to look for patterns
+     * @length - length of string
+     * @searcher - structure with automaton
+     *
+     * @return - 1 if string contains some pattern
+     *         - 0 if not
      */
 
-    if (line->final_cols <= 0)
-    {
-        line->line_string[0] = 0;
-        return;
-    }
+    const Automaton *automaton = searcher->automaton;
+    const int *transitions = automaton->transitions;
+    int num_of_classes = automaton->num_of_classes;
 
-    int i = 0;
-    for (; i < (line->final_cols - 1); i++)
+    int state = 0;
+    for (int i = 0; i < length; i++)
     {
-        line->line_string[i] = line->delim;
+        state = transitions[(size_t)state * num_of_classes + automaton->byte_classes[(unsigned char)string[i]]];
+        if (automaton->matches[state])
+            return 1;
     }
 
-    line->line_string[i] = 0;
+    return 0;
 }
 
-int is_line_empty(Line *line)
+int read_whole_file(const char *file_path, char **data, size_t *size)
 {
     /*
-     * Check if currentl line is empty
-     * Line is empty when line is flagged as deleted or number of colms is 0
+     * Read content of file to allocated buffer
      *
      * params:
-     * @line - structure with line data
+     * @file_path - path to file
+     * @data - output buffer with content (released by caller)
+     * @size - output size of content
      *
-     * @return - 1 if line is empty else 0
+     * @return - NO_ERROR on success
+     *         - INPUT_ERROR if file cant be read
      */
 
-    return (line->deleted || (line->final_cols == 0));
+    FILE *file = fopen(file_path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Cant open file %s\n", file_path);
+        return INPUT_ERROR;
+    }
+
+    size_t capacity = 4096, length = 0;
+    char *buffer = malloc(capacity);
+    size_t read_length = 0;
+
+    while (buffer != NULL && (read_length = fread(buffer + length, 1, capacity - length, file)) > 0)
+    {
+        length += read_length;
+        if (length == capacity)
+        {
+            capacity *= 2;
+            char *new_buffer = realloc(buffer, capacity);
+            if (new_buffer == NULL)
+                free(buffer);
+
+            buffer = new_buffer;
+        }
+    }
+
+    if (buffer == NULL || ferror(file))
+    {
+        fprintf(stderr, "Cant read file %s\n", file_path);
+        free(buffer);
+        fclose(file);
+        return INPUT_ERROR;
+    }
+
+    fclose(file);
+    *data = buffer;
+    *size = length;
+    return NO_ERROR;
 }
 
-void print_line(Line *line)
+int init_set_searcher(Searcher *searcher, const char *file_path)
 {
     /*
-     * Print line and clear it from buffer
+     * Load patterns from file (one pattern on line) and build automaton to search for all of them at once
      *
      * params:
-     * @line - structure with line data
+     * @searcher - structure to initialize
+     * @file_path - path to file with patterns
+     *
+     * @return - NO_ERROR on success
+     *         - INPUT_ERROR if patterns cant be loaded
      */
 
-    if (!is_line_empty(line))
+    searcher->needle = NULL;
+    searcher->needle_len = 0;
+    searcher->search = search_automaton;
+    searcher->automaton = calloc(1, sizeof(Automaton));
+    if (searcher->automaton == NULL)
     {
-#ifdef DEBUG
-        printf("[Line debug] LI: %d, FC: %d, PF: %d Line data:\t\t", line->line_index, line->final_cols, line->process_flag);
-#endif
-
-        printf("%s\n", line->line_string);
+        fprintf(stderr, "Cant allocate memory for patterns\n");
+        return INPUT_ERROR;
     }
 
-    line->line_index++;
-    line->line_string[0] = 0;
+    char *patterns;
+    size_t size;
+    if (read_whole_file(file_path, &patterns, &size) != NO_ERROR)
+        return INPUT_ERROR;
+
+    int error_flag = build_automaton(searcher->automaton, patterns, size);
+    if (error_flag != NO_ERROR)
+        fprintf(stderr, "Cant allocate memory for patterns\n");
+
+    free(patterns);
+    return error_flag;
 }
 
-void delete_line_content(Line *line)
+void free_searcher(Searcher *searcher)
 {
     /*
-     * Delete line string and if line wasnt already empty switch delete flag to true
+     * Release memory of searcher
      *
      * params:
-     * @line - structure with line data
+     * @searcher - structure with searcher data
      */
 
-    if (!is_line_empty(line))
-    {
-        line->line_string[0] = 0;
-        line->deleted = 1;
-    }
+    if (searcher->automaton != NULL)
+        free_automaton(searcher->automaton);
+
+    free(searcher->automaton);
+    searcher->automaton = NULL;
 }
 
-int insert_string_to_line(Line *line, char *insert_string, int index)
+typedef struct
+{
+    // Regex is parsed to tree of nodes by recursive descent
+    const char *pattern;
+    int position;
+    RegexNode *nodes;
+    int num_of_nodes;
+    int nodes_capacity;
+    // Nesting of groups is limited, so recursion of parsing and compilation cant overflow stack
+    int depth;
+    int too_large;
+} RegexParser;
+
+int add_regex_node(RegexParser *parser, int type)
 {
     /*
-     * Insert string to line string
+     * Add empty node to parsed tree
      *
      * params:
-     * @line - structure with line data
-     * @insert_string - string that will be inserted to base_string
-     * @index - index of character from which insert_string will be inserted to base_string
+     * @parser - structure with parser data
+     * @type - type of node
      *
-     * @return - 0 on success
-     *         - -1 on error
+     * @return - index of new node
+     *         - -1 if memory cant be allocated
      */
 
-    size_t base_string_length = strlen(line->line_string);
-    size_t insert_string_length = strlen(insert_string);
-
-    if ((base_string_length + insert_string_length) > MAX_LINE_LEN)
+    if (parser->num_of_nodes == parser->nodes_capacity)
     {
-        fprintf(stderr, "\nLine %d exceded max memory size! Max length of line is %d characters (including delims)\n", line->line_index+1, MAX_LINE_LEN);
-        line->error_flag = MAX_LINE_LEN_EXCEDED;
-        return -1;
+        int capacity = parser->nodes_capacity > 0 ? parser->nodes_capacity * 2 : 64;
+        RegexNode *nodes = realloc(parser->nodes, sizeof(RegexNode) * (size_t)capacity);
+        if (nodes == NULL)
+            return -1;
+
+        parser->nodes = nodes;
+        parser->nodes_capacity = capacity;
     }
 
-    // If index is larger than basestring lenght then insert position is lenght of base string
-    size_t pos = ((size_t)index < base_string_length) ? (size_t)index : base_string_length;
+    RegexNode *node = &parser->nodes[parser->num_of_nodes];
+    memset(node, 0, sizeof(RegexNode));
+    node->type = type;
+    node->left = -1;
+    node->right = -1;
+
+    return parser->num_of_nodes++;
+}
+
+void set_byte_range(unsigned char *bytes, int first, int last)
+{
+    /*
+     * Add range of bytes to bitmap
+     *
+     * params:
+     * @bytes - bitmap of bytes
+     * @first - first byte of range
+     * @last - last byte of range
+     */
+
+    for (int ch = first; ch <= last; ch++)
+        bytes[ch >> 3] |= (unsigned char)(1 << (ch & 7));
+}
 
-    char final_string[MAX_LINE_LEN + 1];
+int set_named_class(unsigned char *bytes, const char *name, int length)
+{
+    /*
+     * Add bytes of named class ([:alpha:] in bracket or \d escape) to bitmap
+     *
+     * params:
+     * @bytes - bitmap of bytes
+     * @name - name of class
+     * @length - length of name
+     *
+     * @return - 1 if class is known
+     *         - 0 if not
+     */
 
-    // Add first part of base string (exclude character on pos index)
-    for (size_t i = 0; i < pos; ++i)
-        final_string[i] = line->line_string[i];
+    const char *NAMES[] = {"alpha", "digit", "alnum", "space", "upper", "lower", "punct", "xdigit", "blank", "cntrl", "print", "graph"};
+    int (*const FUNCTIONS[])(int) = {isalpha, isdigit, isalnum, isspace, isupper, islower, ispunct, isxdigit, isblank, iscntrl, isprint, isgraph};
 
-    // Add insert string
-    for (size_t i = 0; i < insert_string_length; ++i)
-        final_string[pos+i] = insert_string[i];
+    for (size_t i = 0; i < sizeof(NAMES) / sizeof(NAMES[0]); i++)
+    {
+        if ((int)strlen(NAMES[i]) != length || strncmp(NAMES[i], name, length) != 0)
+            continue;
 
-    // Add rest of base string
-    for (size_t i = pos; i < base_string_length; ++i)
-        final_string[i + insert_string_length] = line->line_string[i];
+        for (int ch = 0; ch < 256; ch++)
+        {
+            if (FUNCTIONS[i](ch))
+                set_byte_range(bytes, ch, ch);
+        }
 
-    // Add terminate character to the end
-    final_string[base_string_length + insert_string_length] = 0;
+        return 1;
+    }
 
-    // Copy new string to base string
-    strcpy(line->line_string, final_string);
     return 0;
 }
 
-int remove_substring(char *base_string, int start_index, int end_index)
+int parse_regex_bracket(RegexParser *parser, unsigned char *bytes)
 {
     /*
-     * Remove substring from string base on input indexes
+     * Parse bracket expression ([abc], [^a-z], [[:digit:]_]), position is behind opening bracket
      *
      * params:
-     * @base_string - string from what will be substring removed
-     * @start_index - index of first removed char of substring
-     * @end_index - index of last removed char of substring
+     * @parser - structure with parser data
+     * @bytes - output bitmap of matched bytes
      *
      * @return - 0 on success
-     *         - -1 on error
+     *         - -1 if bracket is invalid
      */
 
-    if (start_index < 0 || end_index < 0 || start_index > end_index)
-        return -1;
+    const char *pattern = parser->pattern;
+    int negate = pattern[parser->position] == '^';
+    if (negate)
+        parser->position++;
 
-    size_t string_len = strlen(base_string);
+    // Closing bracket at first place is normal char
+    int first = 1;
+    while (pattern[parser->position] != ']' || first)
+    {
+        first = 0;
+        if (pattern[parser->position] == 0)
+            return -1;
+
+        if (pattern[parser->position] == '[' && pattern[parser->position + 1] == ':')
+        {
+            const char *name = &pattern[parser->position + 2];
+            const char *end = strstr(name, ":]");
+            if (end == NULL || !set_named_class(bytes, name, (int)(end - name)))
+                return -1;
 
-    char final_string[MAX_LINE_LEN + 1];
-    int i;
+            parser->position = (int)(end - pattern) + 2;
+            continue;
+        }
 
-    // Add first part of string
-    for (i = 0; i < start_index; i++)
-    {
-        final_string[i] = base_string[i];
+        int low = (unsigned char)pattern[parser->position++];
+        int high = low;
+        if (pattern[parser->position] == '-' && pattern[parser->position + 1] != ']' && pattern[parser->position + 1] != 0)
+        {
+            high = (unsigned char)pattern[parser->position + 1];
+            parser->position += 2;
+            if (high < low)
+                return -1;
+        }
+
+        set_byte_range(bytes, low, high);
     }
 
-    // Skip middle part of string and add end part
-    for (size_t j = end_index + 1; j < string_len; ++j, ++i)
+    parser->position++;
+
+    if (negate)
     {
-        final_string[i] = base_string[j];
+        for (int i = 0; i < 32; i++)
+            bytes[i] = (unsigned char)~bytes[i];
     }
 
-    final_string[i] = 0;
-
-    strcpy(base_string, final_string);
     return 0;
 }
 
-int insert_to_cell(Line *line, int index, char *string)
+int parse_regex_alternation(RegexParser *parser);
+
+int parse_regex_atom(RegexParser *parser)
 {
     /*
-     * Insert string to column
+     * Parse single char, class, anchor or group
      *
      * params:
-     * @line - structure with line data
-     * @index - index of column to insert string
-     * @string - string that will be inserted to cell
+     * @parser - structure with parser data
      *
-     * @return - 0 on success
+     * @return - index of node
      *         - -1 on error
      */
 
-    // Get position of first character in cell
-    index = get_start_of_substring(line, index);
-    if (index < 0)
+    char ch = parser->pattern[parser->position++];
+
+    if (ch == '(')
+    {
+        if (parser->depth >= MAX_REGEX_DEPTH)
+        {
+            parser->too_large = 1;
+            return -1;
+        }
+
+        parser->depth++;
+        int node = parse_regex_alternation(parser);
+        parser->depth--;
+        if (node < 0 || parser->pattern[parser->position] != ')')
+            return -1;
+
+        parser->position++;
+        return node;
+    }
+
+    if (ch == '^')
+        return add_regex_node(parser, REGEX_CELL_START);
+
+    if (ch == '$')
+        return add_regex_node(parser, REGEX_CELL_END);
+
+    int node = add_regex_node(parser, REGEX_BYTES);
+    if (node < 0)
         return -1;
 
-    // This will insert string BEFORE the index
-    return insert_string_to_line(line, string, index);
+    unsigned char *bytes = parser->nodes[node].bytes;
+    switch (ch)
+    {
+        case '.':
+            set_byte_range(bytes, 0, 255);
+            break;
+
+        case '[':
+            if (parse_regex_bracket(parser, bytes) != 0)
+                return -1;
+            break;
+
+        case '\\':
+            ch = parser->pattern[parser->position++];
+            if (ch == 0)
+                return -1;
+
+            // Shorthand classes, other escaped chars are matched literally
+            if (ch == 'd' || ch == 'D')
+                set_named_class(bytes, "digit", 5);
+            else if (ch == 's' || ch == 'S')
+                set_named_class(bytes, "space", 5);
+            else if (ch == 'w' || ch == 'W')
+            {
+                set_named_class(bytes, "alnum", 5);
+                set_byte_range(bytes, '_', '_');
+            }
+            else
+            {
+                set_byte_range(bytes, (unsigned char)ch, (unsigned char)ch);
+                break;
+            }
+
+            if (isupper((unsigned char)ch))
+            {
+                for (int i = 0; i < 32; i++)
+                    bytes[i] = (unsigned char)~bytes[i];
+            }
+            break;
+
+        case '*':
+        case '+':
+        case '?':
+        case '{':
+        case ')':
+        case '|':
+        case 0:
+            // Repeat without atom or empty group
+            return -1;
+
+        default:
+            set_byte_range(bytes, (unsigned char)ch, (unsigned char)ch);
+            break;
+    }
+
+    return node;
 }
 
-int insert_empty_cell(Line *line, int index)
+int parse_repeat_count(RegexParser *parser, int *count)
 {
     /*
-     * Insert new cell before the one selected by index
+     * Parse number of repeats in braces
      *
      * params:
-     * @line - structure with line data
-     * @index - index of cell before which will be inserted new cell
+     * @parser - structure with parser data
+     * @count - output number
      *
      * @return - 0 on success
-     *         - -1 on error
+     *         - -1 if there is no number or its too large
      */
 
-    // When inserting to existing row of cells there is always delim
-    char empty_col[2] = {line->delim, '\0'};
+    if (!isdigit((unsigned char)parser->pattern[parser->position]))
+        return -1;
 
-    // Insert string with delim in front of value in cell
-    int ret = insert_to_cell(line, index, empty_col);
-    if (ret == 0)
-        line->final_cols++;
+    *count = 0;
+    while (isdigit((unsigned char)parser->pattern[parser->position]))
+    {
+        *count = *count * 10 + (parser->pattern[parser->position++] - '0');
+        if (*count > MAX_REGEX_REPEAT)
+            return -1;
+    }
 
-    return ret;
+    return 0;
 }
 
-void append_empty_cell(Line *line)
+int parse_regex_repeat(RegexParser *parser)
 {
     /*
-     * Insert empty cell on the end of the line
+     * Parse atom with any number of repeat operators (*, +, ?, {m}, {m,}, {m,n})
      *
      * params:
-     * @line - structure with line data
+     * @parser - structure with parser data
+     *
+     * @return - index of node
+     *         - -1 on error
      */
 
-    if (line->final_cols < 1)
+    int node = parse_regex_atom(parser);
+
+    while (node >= 0)
     {
-        line->final_cols++;
-        return;
-    }
+        char ch = parser->pattern[parser->position];
+        int min, max;
 
-    line->final_cols++;
+        if (ch == '*' || ch == '+' || ch == '?')
+        {
+            parser->position++;
+            min = ch == '+' ? 1 : 0;
+            max = ch == '?' ? 1 : -1;
+        }
+        else if (ch == '{')
+        {
+            parser->position++;
+            if (parse_repeat_count(parser, &min) != 0)
+                return -1;
 
-    char empty_col[2] = {line->delim, '\0'};
+            max = min;
+            if (parser->pattern[parser->position] == ',')
+            {
+                parser->position++;
+                max = -1;
+                if (parser->pattern[parser->position] != '}' && (parse_repeat_count(parser, &max) != 0 || max < min))
+                    return -1;
+            }
+
+            if (parser->pattern[parser->position++] != '}')
+                return -1;
+        }
+        else
+            break;
+
+        int repeat = add_regex_node(parser, REGEX_REPEAT);
+        if (repeat < 0)
+            return -1;
+
+        parser->nodes[repeat].left = node;
+        parser->nodes[repeat].min = min;
+        parser->nodes[repeat].max = max;
+        node = repeat;
+    }
 
-    // Insert new empty colm and check sanity of that line
-    strcat(line->line_string, empty_col);
-    check_line_sanity(line);
+    return node;
 }
 
-int remove_cell(Line *line, int index)
+int parse_regex_concatenation(RegexParser *parser)
 {
     /*
-     * Remove whole cell
+     * Parse sequence of repeated atoms until end of alternative
      *
      * params:
-     * @line - structure with line data
-     * @index - index of cell to remove
+     * @parser - structure with parser data
      *
-     * @return - 0 on success
+     * @return - index of node
      *         - -1 on error
      */
 
-    int start_index = get_start_of_substring(line, index);
-    // offset to delim in front of substring if there is any to delete it
-    if (index != 0 && (line->final_cols - 1) == index)
-        start_index -= 1;
+    int node = add_regex_node(parser, REGEX_EMPTY);
 
-    // offset to delim char after the substring
-    int end_index = get_end_of_substring(line, index) + 1;
-    int ret = remove_substring(line->line_string, start_index, end_index);
+    while (node >= 0)
+    {
+        char ch = parser->pattern[parser->position];
+        if (ch == 0 || ch == '|' || ch == ')')
+            break;
 
-    if (ret == 0)
-        line->final_cols--;
+        int next = parse_regex_repeat(parser);
+        if (next < 0)
+            return -1;
 
-    return ret;
+        int concatenation = add_regex_node(parser, REGEX_CONCAT);
+        if (concatenation < 0)
+            return -1;
+
+        parser->nodes[concatenation].left = node;
+        parser->nodes[concatenation].right = next;
+        node = concatenation;
+    }
+
+    return node;
 }
 
-int clear_cell(Line *line, int index)
+int parse_regex_alternation(RegexParser *parser)
 {
     /*
-     * Clear value from cell
+     * Parse alternatives separated by |
      *
-     * param:
-     * @line - structure with line data
-     * @index - index of cell to clear
+     * params:
+     * @parser - structure with parser data
      *
-     * @return - 0 on success
+     * @return - index of node
      *         - -1 on error
      */
 
-    if (index < 0)
-        return -1;
+    int node = parse_regex_concatenation(parser);
 
-    int start_index = get_start_of_substring(line, index);
-    int end_index = get_end_of_substring(line, index);
+    while (node >= 0 && parser->pattern[parser->position] == '|')
+    {
+        parser->position++;
+        int next = parse_regex_concatenation(parser);
+        if (next < 0)
+            return -1;
 
-    if (start_index < 0 || end_index < 0)
-        return -1;
+        int alternation = add_regex_node(parser, REGEX_ALTERNATION);
+        if (alternation < 0)
+            return -1;
 
-    // Remove subring with value of cell
-    return remove_substring(line->line_string, start_index, end_index);
+        parser->nodes[alternation].left = node;
+        parser->nodes[alternation].right = next;
+        node = alternation;
+    }
+
+    return node;
 }
 
-void get_selector(Selector *selector, int argc, char *argv[])
+int add_regex_state(Regex *regex, int type, int next, int alternative)
 {
     /*
-     * Get line selector from arguments
-     * Only first valid selector is loaded
+     * Add state to NFA of regex
      *
      * params:
-     * @selector - structor to save params for selector
-     * @argc - length of argument array
-     * @argv - argument array
+     * @regex - structure with regex data
+     * @type - type of state
+     * @next - next state
+     * @alternative - second next state of split
+     *
+     * @return - index of new state
+     *         - -1 if regex has too many states or memory cant be allocated
      */
 
-    // Offset -2 to be sure that there will be another 2 args after the selector flag
-    for (int i = 1; i < (argc - 2); i++)
+    if (regex->num_of_states >= MAX_REGEX_STATES)
+        return -1;
+
+    if (regex->num_of_states == regex->states_capacity)
     {
-        for (int j = 0; j < NUMBER_OF_SELECTOR_COMS; j++)
-        {
-            if (strcmp(argv[i], SELECTOR_COMS[j]) == 0)
-            {
-                switch (j)
-                {
-                    case 0:
-                        // rows selector is valid when both arguments are int > 0 and a1 < a2 or -
-                        if (((argument_to_int(argv, argc, i+1) > 0) || strings_equal(argv[i + 1], "-")) &&
-                            ((argument_to_int(argv, argc, i+2) > 0) || strings_equal(argv[i + 2], "-")))
-                        {
-                            if (is_string_int(argv[i+1]) && is_string_int(argv[i+2]) &&
-                                (argument_to_int(argv, argc, i+1) > argument_to_int(argv, argc, i+2)))
-                            {
-                                break;
-                            }
-
-                            selector->selector_type = j;
-                            selector->a1 = argv[i+1];
-                            selector->a2 = argv[i+2];
-                            selector->ai1 = argument_to_int(argv, argc, i+1);
-                            selector->ai2 = argument_to_int(argv, argc, i+2);
-                            return;
-                        }
-                        break;
-
-                    case 1:
-                    case 2:
-                        if ((argument_to_int(argv, argc, i+1) > 0) || strings_equal(argv[i + 1], "-"))
-                        {
-                            selector->selector_type = j;
-                            selector->a1 = argv[i+1];
-                            selector->ai1 = argument_to_int(argv, argc, i+1);
-                            selector->str = argv[i+2];
-                            return;
-                        }
-                        break;
-
-                    default:
-                        break;
-                }
-            }
-        }
+        int capacity = regex->states_capacity > 0 ? regex->states_capacity * 2 : 64;
+        RegexState *states = realloc(regex->states, sizeof(RegexState) * (size_t)capacity);
+        if (states == NULL)
+            return -1;
+
+        regex->states = states;
+        regex->states_capacity = capacity;
     }
 
-    // If valid selector not found set selector type to -1
-    selector->selector_type = -1;
+    RegexState *state = &regex->states[regex->num_of_states];
+    memset(state, 0, sizeof(RegexState));
+    state->type = type;
+    state->next = next;
+    state->alternative = alternative;
+
+    return regex->num_of_states++;
 }
 
-int is_cell_index_valid(Line *line, int index)
+int emit_regex_node(Regex *regex, const RegexNode *nodes, int node, int out)
 {
     /*
-     * Check if input index is valid index of cell in row
+     * Build NFA states of node, states are built from end so every fragment knows state that follows it
      *
      * params:
-     * @line - structure with line data
-     * @index - index of cell to check
+     * @regex - structure with regex data
+     * @nodes - parsed tree
+     * @node - index of node
+     * @out - state that follows the node
      *
-     * @return - 1 if is valid
-     *         - 0 if not
+     * @return - entry state of node
+     *         - -1 on error
      */
 
-    return ((index > 0) && (index <= line->final_cols));
-}
+    const RegexNode *current = &nodes[node];
+    int entry, split;
 
-void validate_line_processing(Line *line, Selector *selector)
-{
-    /*
-     * Check if current line is marked by selector for processing (selected by selector)
-     *
-     * params:
-     * @line - structure with line data
-     * @selector - structure with selector params
-     */
+    if (out < 0)
+        return -1;
 
-    switch (selector->selector_type)
+    switch (current->type)
     {
-        case 0:
-            // rows N M
-            // If both args are - then allow only last line
-            // If arg 1 is larger than 0 and arg 2 is - then check if current line index is larger or equal arg 1
-            // If both args are numbers larger than 0 then check if current line index is between or equal
-            if ((strings_equal(selector->a1, "-") && strings_equal(selector->a2, "-") && line->last_line_flag) ||
-                (selector->ai1 > 0 && strings_equal(selector->a2, "-") && line->line_index >= (selector->ai1 - 1)) ||
-                (selector->ai1 > 0 && selector->ai2 > 0 && line->line_index >= (selector->ai1 - 1) && line->line_index <= (selector->ai2 - 1)))
-            {
-                line->process_flag = 1;
-                return;
-            }
-            break;
+        case REGEX_EMPTY:
+            return out;
 
-        case 1:
-            // beginswith C STR
-            if (is_cell_index_valid(line, selector->ai1))
+        case REGEX_BYTES:
+            if ((entry = add_regex_state(regex, STATE_BYTES, out, -1)) >= 0)
+                memcpy(regex->states[entry].bytes, current->bytes, sizeof(current->bytes));
+            return entry;
+
+        case REGEX_CELL_START:
+            return add_regex_state(regex, STATE_CELL_START, out, -1);
+
+        case REGEX_CELL_END:
+            return add_regex_state(regex, STATE_CELL_END, out, -1);
+
+        case REGEX_CONCAT:
+            return emit_regex_node(regex, nodes, current->left, emit_regex_node(regex, nodes, current->right, out));
+
+        case REGEX_ALTERNATION:
+            entry = emit_regex_node(regex, nodes, current->left, out);
+            split = emit_regex_node(regex, nodes, current->right, out);
+            return entry < 0 || split < 0 ? -1 : add_regex_state(regex, STATE_SPLIT, entry, split);
+
+        case REGEX_REPEAT:
+            if (current->max < 0)
             {
-                char substr[MAX_CELL_LEN + 1];
-                if (get_value_of_cell(line, selector->ai1 - 1, substr) == 0)
-                {
-                    // Check if selected cell starts with string from argument
-                    if (string_start_with(substr, selector->str))
-                    {
-                        line->process_flag = 1;
-                        return;
-                    }
-                }
-            }
-            break;
+                // Loop, body returns back to split
+                if ((split = add_regex_state(regex, STATE_SPLIT, -1, out)) < 0)
+                    return -1;
 
-        case 2:
-            // contains C STR
-            if (is_cell_index_valid(line, selector->ai1))
+                if ((entry = emit_regex_node(regex, nodes, current->left, split)) < 0)
+                    return -1;
+
+                regex->states[split].next = entry;
+                out = split;
+            }
+            else
             {
-                char substr[MAX_CELL_LEN + 1];
-                if (get_value_of_cell(line, selector->ai1 - 1, substr) == 0)
+                // Optional copies of node
+                for (int i = current->min; i < current->max && out >= 0; i++)
                 {
-                    // Check if cell contains string from argument
-                    if (strstr(substr, selector->str) != NULL)
-                    {
-                        line->process_flag = 1;
-                        return;
-                    }
+                    entry = emit_regex_node(regex, nodes, current->left, out);
+                    out = entry < 0 ? -1 : add_regex_state(regex, STATE_SPLIT, entry, out);
                 }
             }
-            break;
+
+            // Required copies of node
+            for (int i = 0; i < current->min && out >= 0; i++)
+                out = emit_regex_node(regex, nodes, current->left, out);
+
+            return out;
 
         default:
-            // If there is no valid selector then set processing flag to 1
-            line->process_flag = 1;
-            return;
+            return -1;
     }
-
-    // If selector contains some garbage or the current line is not valid by selector then set processing flag to 0
-    line->process_flag = 0;
 }
 
-int process_row_values(Line *line, int start_index, int end_index, double *ret_val, int function_flag)
+void compute_regex_byte_classes(Regex *regex)
 {
     /*
-     * Process and return value of operation performed on row
-     * Supported functions: SUM - sum of selected number cells
-     *                      MIN - minimum value of selected number cells
-     *                      MAX - maximum value of selected number cells
-     *                      COUNT - count number of non empty cells
-     * params:
-     * @line - structure with line data
-     * @start_index - start index of sum interval
-     * @end_index - end index of sum interval
-     * @ret_val - return pointer for value
-     * @function_flag - flag of function used to aquire return value
+     * Split bytes to classes, bytes of one class are accepted by the same states
      *
-     * @return - number cells it run thru
-     *         - -1 on fail
+     * params:
+     * @regex - structure with regex data
      */
 
-    if (is_cell_index_valid(line, start_index) && end_index > 0 &&
-        start_index <= end_index)
+    memset(regex->byte_classes, 0, sizeof(regex->byte_classes));
+    regex->num_of_classes = 1;
+
+    for (int i = 0; i < regex->num_of_states; i++)
     {
-        char cell_buff[MAX_CELL_LEN + 1];
-        double return_value = 0;
-        int cell_count = 0;
+        if (regex->states[i].type != STATE_BYTES)
+            continue;
 
-        // Set initial return numbers for min/max functions
-        if (function_flag == MIN || function_flag == MAX)
-            return_value = function_flag == MIN ? DBL_MAX : DBL_MIN;
+        // Every class is split to bytes that are accepted by state and bytes that are not
+        int accepted_classes[256], rejected_classes[256];
+        memset(accepted_classes, -1, sizeof(accepted_classes));
+        memset(rejected_classes, -1, sizeof(rejected_classes));
+        int num_of_classes = 0;
 
-        for (int i = start_index; i <= end_index; i++)
+        for (int ch = 0; ch < 256; ch++)
         {
-            // Load value of cell
-            if (get_value_of_cell(line, i - 1, cell_buff) == 0)
-            {
-                // Check if string is number
-                if (is_string_double(cell_buff))
-                {
-                    double buf;
-
-                    // Convert string to double
-                    if (string_to_double(cell_buff, &buf) == 0)
-                    {
-                        switch (function_flag)
-                        {
-                            case AVG:
-                            case SUM:
-                                return_value += buf;
-                                break;
-
-                            case MIN:
-                                if (buf < return_value)
-                                    return_value = buf;
-                                break;
-
-                            case MAX:
-                                if (buf > return_value)
-                                    return_value = buf;
-                                break;
-
-                            default:
-                                break;
-                        }
-                    }
-                }
+            int *classes = (regex->states[i].bytes[ch >> 3] >> (ch & 7)) & 1 ? accepted_classes : rejected_classes;
+            if (classes[regex->byte_classes[ch]] < 0)
+                classes[regex->byte_classes[ch]] = num_of_classes++;
 
-                // When we are in counting mode then cell count is our output value and we want count only not empty cells
-                if (function_flag != COUNT || cell_buff[0] != 0)
-                    cell_count++;
-            }
-            else if (line->error_flag)
-                return -1;
+            regex->byte_classes[ch] = (unsigned char)classes[regex->byte_classes[ch]];
         }
 
-        // If return value is still at initial values then no valid value was processed
-        if (return_value == DBL_MIN || return_value == DBL_MAX)
-            return -1;
-
-        // If mode is count then we want return cell count as output
-        if (function_flag == COUNT)
-            (*ret_val) = (double)cell_count;
-        else
-            (*ret_val) = return_value;
-
-        return cell_count;
+        regex->num_of_classes = num_of_classes;
     }
 
-    return -1;
+    for (int ch = 255; ch >= 0; ch--)
+        regex->class_bytes[regex->byte_classes[ch]] = (unsigned char)ch;
 }
 
-void create_emty_row_at(Line *line, char *line_buffer, int index)
+int regex_matches_empty(const Regex *regex)
 {
     /*
-     * Create empty row before index row in line string
+     * Check if match state is reachable from start without reading byte when all assertions pass
      *
      * params:
-     * @line - structure with line data
-     * @line_buffer - output buffer for current content of line
-     * @index - index of row where to create empty line
+     * @regex - structure with regex data
+     *
+     * @return - 1 if regex matches empty string
+     *         - 0 if not
      */
 
-    if ((index > 0) && (index == (line->line_index + 1)))
+    char *visited = calloc((size_t)regex->num_of_states, 1);
+    int *stack = malloc(sizeof(int) * (size_t)regex->num_of_states);
+    int stack_length = 0, result = 0;
+
+    if (visited != NULL && stack != NULL)
     {
-        // Copy current line to unedited line buffer
-        strcpy(line_buffer, line->unedited_line_string);
-        // Create empty line in line object
-        generate_empty_row(line);
+        visited[regex->start] = 1;
+        stack[stack_length++] = regex->start;
+    }
+
+    while (stack_length > 0 && !result)
+    {
+        const RegexState *state = &regex->states[stack[--stack_length]];
+        int next[2] = {state->type == STATE_BYTES || state->type == STATE_MATCH ? -1 : state->next,
+                       state->type == STATE_SPLIT ? state->alternative : -1};
+
+        result = state->type == STATE_MATCH;
+        for (int i = 0; i < 2; i++)
+        {
+            if (next[i] >= 0 && !visited[next[i]])
+            {
+                visited[next[i]] = 1;
+                stack[stack_length++] = next[i];
+            }
+        }
     }
+
+    free(visited);
+    free(stack);
+    return result;
 }
 
-void delete_rows_in_interval(Line *line, int start_index, int end_index)
+int compile_regex(Regex *regex, const char *pattern)
 {
     /*
-     * Delete row if index of line is in passed interval
-     * Start and end indexes included
+     * Compile regex (extended syntax) to NFA
      *
      * params:
-     * @line - structure with line data
-     * @start_index - start index value
-     * @end_index - end index value
+     * @regex - structure to initialize
+     * @pattern - regex string
+     *
+     * @return - NO_ERROR on success
+     *         - INPUT_ERROR if regex is invalid or too large
      */
 
-    if (start_index > 0 && end_index > 0 &&
-        start_index <= end_index)
+    regex->states = NULL;
+    regex->num_of_states = 0;
+    regex->states_capacity = 0;
+    regex->id = 0;
+
+    RegexParser parser = {pattern, 0, NULL, 0, 0, 0, 0};
+    int root = parse_regex_alternation(&parser);
+
+    if (parser.too_large)
     {
-        // If line index is in interval delete it
-        if (start_index <= (line->line_index + 1) && end_index >= (line->line_index + 1))
-        {
-            delete_line_content(line);
-        }
+        fprintf(stderr, "Regular expression %s is too large\n", pattern);
+        free(parser.nodes);
+        return INPUT_ERROR;
+    }
+
+    // Whole pattern has to be parsed, rest after unmatched closing parenthesis is error
+    if (root < 0 || pattern[parser.position] != 0)
+    {
+        fprintf(stderr, "Invalid regular expression %s\n", pattern);
+        free(parser.nodes);
+        return INPUT_ERROR;
     }
+
+    int match = add_regex_state(regex, STATE_MATCH, -1, -1);
+    regex->start = emit_regex_node(regex, parser.nodes, root, match);
+    free(parser.nodes);
+
+    if (regex->start < 0)
+    {
+        fprintf(stderr, "Regular expression %s is too large\n", pattern);
+        return INPUT_ERROR;
+    }
+
+    compute_regex_byte_classes(regex);
+    regex->matches_empty = regex_matches_empty(regex);
+    return NO_ERROR;
 }
 
-void insert_empty_cell_at(Line *line, int index)
+void free_regex(Regex *regex)
 {
     /*
-     * Insert empty cell before cell of passed index if that cell exist
+     * Release memory of compiled regex
      *
      * params:
-     * @line - structure with line data
-     * @index - input index of cell
+     * @regex - structure with regex data
      */
 
-    // If cell index is valid insert empty cell before index
-    if (is_cell_index_valid(line, index))
-    {
-        insert_empty_cell(line, index - 1);
-    }
+    free(regex->states);
+    regex->states = NULL;
 }
 
-void delete_cells_in_interval(Line *line, int start_index, int end_index)
+void flush_regex_cache(RegexCache *cache)
 {
     /*
-     * Delete cells with indexes in input interval
-     * In loop delete first cell several times
+     * Remove all states of DFA, they are built again when they are needed
      *
      * params:
-     * @line - structure with line data
-     * @start_index - start index value
-     * @end_index - end index value
+     * @cache - structure with DFA data
      */
 
-    if (is_cell_index_valid(line, start_index) && end_index > 0 && start_index <= end_index)
-    {
-        // I am lazy to count number of loops
-        for (int j = start_index; j <= end_index; j++)
-        {
-            // If line is not empty try to remove cell
-            if (!is_line_empty(line))
-                remove_cell(line, start_index - 1);
-        }
-    }
+    cache->num_of_states = 0;
+    cache->start_state = -1;
+    cache->sets_length = 0;
+
+    for (int i = 0; i < DFA_TABLE_SIZE; i++)
+        cache->table[i] = -1;
 }
 
-int set_value_in_cell(Line *line, int index, char *value)
+void free_regex_cache(RegexCache *cache)
 {
     /*
-     * Clear content of cell and insert new value
+     * Release memory of DFA cache
      *
      * params:
-     * @line - structure with line data
-     * @index - index of cell set value
-     * @value - string to set
-     *
-     * @return - 0 on sucess
-     *         - -1 on error
+     * @cache - structure with DFA data
      */
 
-    if (is_cell_index_valid(line, index))
-    {
-        // Clear value from cell
-        clear_cell(line, index - 1);
-        // Set new value to cell
-        return insert_to_cell(line, index - 1, value);
-    }
+    if (cache == NULL)
+        return;
 
-    return -1;
+    free(cache->transitions);
+    free(cache->flags);
+    free(cache->set_starts);
+    free(cache->set_lengths);
+    free(cache->table);
+    free(cache->set);
+    free(cache->stack);
+    free(cache->marks);
+    free(cache->sets);
+    free(cache);
 }
 
-void cell_value_editing(Line *line, int index, int processing_flag)
+RegexCache *create_regex_cache(const Regex *regex)
 {
     /*
-     * Function to process value of single cell
-     * Supported functions: UPPER - to uppercase
-     *                      LOWER - to lowercase
-     *                      ROUND - round value if its number
-     *                      INT - conver value to int if its number
+     * Allocate empty DFA cache for regex
      *
      * params:
-     * @line - structure with line data
-     * @index - index of cell
-     * @processing_flag - flag of function
+     * @regex - compiled regex
+     *
+     * @return - new cache
+     *         - NULL if memory cant be allocated
      */
 
-    if (is_cell_index_valid(line, index))
-    {
-        char cell_buff[MAX_CELL_LEN + 1];
-
-        // Load value from cell
-        if (get_value_of_cell(line, index - 1, cell_buff) == 0)
-        {
-            // Check if the cell is not number (int should be double too)
-            if (!is_string_double(cell_buff))
-            {
-                // Upper/lower conversion of string
-                if (processing_flag == UPPER)
-                    string_conversion(cell_buff, UPPER);
-                else if (processing_flag == LOWER)
-                    string_conversion(cell_buff, LOWER);
-            }
-            else if (processing_flag == ROUND || processing_flag == INT)
-            {
-                double cell_double;
-
-                // Convert string to double
-                if (string_to_double(cell_buff, &cell_double) == 0)
-                {
-                    // Round/int double processing
-                    if (processing_flag == ROUND)
-                        snprintf(cell_buff, MAX_CELL_LEN + 1, "%d", round_double(cell_double));
-                    else
-                        snprintf(cell_buff, MAX_CELL_LEN + 1, "%d", (int)cell_double);
-                }
-            }
+    RegexCache *cache = calloc(1, sizeof(RegexCache));
+    if (cache == NULL)
+        return NULL;
 
-            // Set processed value to cell
-            set_value_in_cell(line, index, cell_buff);
-        }
+    cache->regex = regex;
+    cache->transitions = malloc(sizeof(int) * (size_t)MAX_DFA_STATES * regex->num_of_classes);
+    cache->flags = malloc(MAX_DFA_STATES);
+    cache->set_starts = malloc(sizeof(size_t) * MAX_DFA_STATES);
+    cache->set_lengths = malloc(sizeof(int) * MAX_DFA_STATES);
+    cache->table = malloc(sizeof(int) * DFA_TABLE_SIZE);
+    cache->set = malloc(sizeof(int) * (size_t)regex->num_of_states);
+    cache->stack = malloc(sizeof(int) * (size_t)regex->num_of_states);
+    cache->marks = calloc((size_t)regex->num_of_states, sizeof(int));
+    cache->sets_capacity = (size_t)regex->num_of_states * 16;
+    cache->sets = malloc(sizeof(int) * cache->sets_capacity);
+
+    if (cache->transitions == NULL || cache->flags == NULL || cache->set_starts == NULL || cache->set_lengths == NULL ||
+        cache->table == NULL || cache->set == NULL || cache->stack == NULL || cache->marks == NULL || cache->sets == NULL)
+    {
+        free_regex_cache(cache);
+        return NULL;
     }
+
+    flush_regex_cache(cache);
+    return cache;
 }
 
-void copy_cell_value_to(Line *line, int source_index, int target_index)
+void start_regex_set(RegexCache *cache)
 {
     /*
-     * Copy value from one cell to another
-     * Source and target index cant be same
+     * Start building of new set of NFA states
      *
      * params:
-     * @line - structure with line data
-     * @source_index - index of source cell
-     * @target_index - index of destination cell
+     * @cache - structure with DFA data
      */
 
-    if (is_cell_index_valid(line, source_index) && is_cell_index_valid(line, target_index) &&
-        source_index != target_index)
-    {
-        char cell_buff[MAX_CELL_LEN + 1];
+    cache->set_length = 0;
 
-        // Load value of source cell
-        if (get_value_of_cell(line, source_index - 1, cell_buff) == 0)
-            // Set value to target cell
-            set_value_in_cell(line, target_index, cell_buff);
+    // Marks of previous sets are invalidated by new mark value
+    if (++cache->mark == INT_MAX)
+    {
+        memset(cache->marks, 0, sizeof(int) * (size_t)cache->regex->num_of_states);
+        cache->mark = 1;
     }
 }
 
-void swap_cell_values(Line *line, int index1, int index2)
+void add_regex_closure(RegexCache *cache, int state, int cell_start)
 {
     /*
-     * Swap values of cells
-     * Index1 and index2 can be same
+     * Add NFA state and all states reachable from it without reading byte to built set
+     * Only states that read byte, match and cell end assertions are kept in set
      *
      * params:
-     * @line - structure with line data
-     * @index1 - index of first cell
-     * @index2 - index of second cell
+     * @cache - structure with DFA data
+     * @state - NFA state
+     * @cell_start - flag if position is at start of cell (cell start assertions pass)
      */
 
-    if (is_cell_index_valid(line, index1) && is_cell_index_valid(line, index2) &&
-        index1 != index2)
+    const RegexState *states = cache->regex->states;
+    int stack_length = 0;
+
+    if (cache->marks[state] == cache->mark)
+        return;
+
+    cache->marks[state] = cache->mark;
+    cache->stack[stack_length++] = state;
+
+    while (stack_length > 0)
     {
-        char cell_buff1[MAX_CELL_LEN + 1];
-        char cell_buff2[MAX_CELL_LEN + 1];
+        state = cache->stack[--stack_length];
+        int next[2] = {-1, -1};
 
-        // Load both cells
-        if ((get_value_of_cell(line, index1 - 1, cell_buff1) == 0) && (get_value_of_cell(line, index2 - 1, cell_buff2) == 0))
+        switch (states[state].type)
         {
-            // Set new values to cells
-            set_value_in_cell(line, index1, cell_buff2);
-            set_value_in_cell(line, index2, cell_buff1);
+            case STATE_SPLIT:
+                next[0] = states[state].next;
+                next[1] = states[state].alternative;
+                break;
+
+            case STATE_CELL_START:
+                if (cell_start)
+                    next[0] = states[state].next;
+                break;
+
+            default:
+                cache->set[cache->set_length++] = state;
+                break;
+        }
+
+        for (int i = 0; i < 2; i++)
+        {
+            if (next[i] >= 0 && cache->marks[next[i]] != cache->mark)
+            {
+                cache->marks[next[i]] = cache->mark;
+                cache->stack[stack_length++] = next[i];
+            }
         }
     }
 }
 
-void move_cell_to(Line *line, int source_index, int target_index)
+int compare_ints(const void *a, const void *b)
+{
+    int first = *(const int *)a, second = *(const int *)b;
+    return (first > second) - (first < second);
+}
+
+int get_dfa_state_flags(RegexCache *cache, const int *set, int length)
 {
     /*
-     * Move cell of source index before cell of target index
-     * Source and target index cant be same
+     * Check if set of NFA states matches now or at end of cell
      *
      * params:
-     * @line - structure with line data
-     * @source_index - index of cell to move
-     * @target_index - index of cell to move to
+     * @cache - structure with DFA data
+     * @set - set of NFA states
+     * @length - size of set
+     *
+     * @return - DFA_MATCH and DFA_MATCH_AT_END flags
+     */
+
+    const RegexState *states = cache->regex->states;
+    int stack_length = 0;
+
+    start_regex_set(cache);
+    for (int i = 0; i < length; i++)
+    {
+        if (states[set[i]].type == STATE_MATCH)
+            return DFA_MATCH | DFA_MATCH_AT_END;
+
+        if (states[set[i]].type == STATE_CELL_END)
+        {
+            cache->marks[set[i]] = cache->mark;
+            cache->stack[stack_length++] = set[i];
+        }
+    }
+
+    // At end of cell also states behind cell end assertions are reached
+    while (stack_length > 0)
+    {
+        int state = cache->stack[--stack_length];
+        int next[2] = {-1, -1};
+
+        switch (states[state].type)
+        {
+            case STATE_MATCH:
+                return DFA_MATCH_AT_END;
+
+            case STATE_SPLIT:
+                next[0] = states[state].next;
+                next[1] = states[state].alternative;
+                break;
+
+            case STATE_CELL_END:
+                next[0] = states[state].next;
+                break;
+
+            default:
+                break;
+        }
+
+        for (int i = 0; i < 2; i++)
+        {
+            if (next[i] >= 0 && cache->marks[next[i]] != cache->mark)
+            {
+                cache->marks[next[i]] = cache->mark;
+                cache->stack[stack_length++] = next[i];
+            }
+        }
+    }
+
+    return 0;
+}
+
+int get_dfa_state(RegexCache *cache)
+{
+    /*
+     * Find DFA state for built set of NFA states, new state is added when its not in cache
+     * Cache is flushed when its full
+     *
+     * params:
+     * @cache - structure with DFA data
+     *
+     * @return - index of DFA state
+     *         - -1 if memory cant be allocated
+     */
+
+    qsort(cache->set, (size_t)cache->set_length, sizeof(int), compare_ints);
+
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < cache->set_length; i++)
+        hash = (hash ^ (unsigned int)cache->set[i]) * 16777619u;
+
+    unsigned int position = hash & (DFA_TABLE_SIZE - 1);
+    for (; cache->table[position] >= 0; position = (position + 1) & (DFA_TABLE_SIZE - 1))
+    {
+        int state = cache->table[position];
+        if (cache->set_lengths[state] == cache->set_length &&
+            memcmp(&cache->sets[cache->set_starts[state]], cache->set, sizeof(int) * (size_t)cache->set_length) == 0)
+            return state;
+    }
+
+    if (cache->num_of_states == MAX_DFA_STATES)
+    {
+        flush_regex_cache(cache);
+        position = hash & (DFA_TABLE_SIZE - 1);
+    }
+
+    if (cache->sets_length + (size_t)cache->set_length > cache->sets_capacity)
+    {
+        size_t capacity = (cache->sets_length + (size_t)cache->set_length) * 2;
+        int *sets = realloc(cache->sets, sizeof(int) * capacity);
+        if (sets == NULL)
+            return -1;
+
+        cache->sets = sets;
+        cache->sets_capacity = capacity;
+    }
+
+    int state = cache->num_of_states++;
+    cache->set_starts[state] = cache->sets_length;
+    cache->set_lengths[state] = cache->set_length;
+    memcpy(&cache->sets[cache->sets_length], cache->set, sizeof(int) * (size_t)cache->set_length);
+    cache->sets_length += (size_t)cache->set_length;
+    cache->table[position] = state;
+
+    int *row = &cache->transitions[(size_t)state * cache->regex->num_of_classes];
+    for (int i = 0; i < cache->regex->num_of_classes; i++)
+        row[i] = -1;
+
+    cache->flags[state] = (char)get_dfa_state_flags(cache, &cache->sets[cache->set_starts[state]], cache->set_length);
+    return state;
+}
+
+int get_dfa_transition(RegexCache *cache, int state, int byte_class)
+{
+    /*
+     * Compute transition of DFA state for byte class and save it to cache
+     *
+     * params:
+     * @cache - structure with DFA data
+     * @state - DFA state
+     * @byte_class - class of read byte
+     *
+     * @return - next DFA state
+     *         - -1 if memory cant be allocated
+     */
+
+    const Regex *regex = cache->regex;
+    int ch = regex->class_bytes[byte_class];
+
+    // Set of current state can be moved by flush, so next set is built before lookup
+    start_regex_set(cache);
+    const int *set = &cache->sets[cache->set_starts[state]];
+    for (int i = 0; i < cache->set_lengths[state]; i++)
+    {
+        const RegexState *nfa_state = &regex->states[set[i]];
+        if (nfa_state->type == STATE_BYTES && ((nfa_state->bytes[ch >> 3] >> (ch & 7)) & 1))
+            add_regex_closure(cache, nfa_state->next, 0);
+    }
+
+    // Match can start at every position of cell
+    add_regex_closure(cache, regex->start, 0);
+
+    int num_of_states = cache->num_of_states;
+    int next_state = get_dfa_state(cache);
+
+    // Transition is saved only if state wasnt removed by flush (flush leaves only the new state in cache)
+    if (next_state >= 0 && cache->num_of_states >= num_of_states)
+        cache->transitions[(size_t)state * regex->num_of_classes + byte_class] = next_state;
+
+    return next_state;
+}
+
+int search_regex(RegexCache *cache, const char *string, int length)
+{
+    /*
+     * Check if regex matches some part of string, every byte is one step of DFA
+     *
+     * params:
+     * @cache - structure with DFA data
+     * @string - string where to look for match
+     * @length - length of string
+     *
+     * @return - 1 if regex matches
+     *         - 0 if not
+     *         - -1 if memory cant be allocated
+     */
+
+    const Regex *regex = cache->regex;
+
+    // Empty cell is the only case when start and end of cell are at the same position
+    if (length == 0)
+        return regex->matches_empty;
+
+    if (cache->start_state < 0)
+    {
+        start_regex_set(cache);
+        add_regex_closure(cache, regex->start, 1);
+        if ((cache->start_state = get_dfa_state(cache)) < 0)
+            return -1;
+    }
+
+    int state = cache->start_state;
+    for (int i = 0; i < length && !(cache->flags[state] & DFA_MATCH); i++)
+    {
+        int byte_class = regex->byte_classes[(unsigned char)string[i]];
+        int next_state = cache->transitions[(size_t)state * regex->num_of_classes + byte_class];
+        if (next_state < 0 && (next_state = get_dfa_transition(cache, state, byte_class)) < 0)
+            return -1;
+
+        state = next_state;
+    }
+
+    return (cache->flags[state] & DFA_MATCH_AT_END) != 0;
+}
+
+void free_arena(Arena *arena)
+{
+    /*
+     * Release all blocks of arena
+     *
+     * params:
+     * @arena - structure with arena data
+     */
+
+    while (arena->current != NULL)
+    {
+        ArenaBlock *previous = arena->current->previous;
+        free(arena->current);
+        arena->current = previous;
+    }
+
+    arena->capacity = 0;
+}
+
+ArenaBlock *add_arena_block(Arena *arena, size_t capacity)
+{
+    /*
+     * Allocate new block of arena, following allocations are taken from it
+     *
+     * params:
+     * @arena - structure with arena data
+     * @capacity - size of block data
+     *
+     * @return - new block
+     *         - NULL if memory cant be allocated
+     */
+
+    ArenaBlock *block = malloc(sizeof(ArenaBlock) + capacity);
+    if (block == NULL)
+        return NULL;
+
+    block->previous = arena->current;
+    block->capacity = capacity;
+    block->used = 0;
+
+    arena->current = block;
+    arena->capacity += capacity;
+    return block;
+}
+
+void *arena_alloc(Arena *arena, size_t size)
+{
+    /*
+     * Allocate memory from arena, memory is valid until arena is reset
+     * Allocated memory is never moved, so pointers to older allocations stay valid when arena grows
+     *
+     * params:
+     * @arena - structure with arena data
+     * @size - size of allocation
+     *
+     * @return - pointer to allocated memory
+     *         - NULL if memory cant be allocated
+     */
+
+    size = (size + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1);
+
+    ArenaBlock *block = arena->current;
+    if (block == NULL || block->capacity - block->used < size)
+    {
+        // Size of arena is at least doubled
+        size_t capacity = arena->capacity < ARENA_BLOCK_SIZE ? ARENA_BLOCK_SIZE : arena->capacity;
+        if (capacity < size)
+            capacity = size;
+
+        if ((block = add_arena_block(arena, capacity)) == NULL)
+            return NULL;
+    }
+
+    void *memory = block->data + block->used;
+    block->used += size;
+    return memory;
+}
+
+void reset_arena(Arena *arena)
+{
+    /*
+     * Release all allocations of arena at once
+     * Arena with more blocks is replaced by single block of their size, so memory is allocated only until
+     * arena is large enough for the largest row
+     *
+     * params:
+     * @arena - structure with arena data
+     */
+
+    if (arena->current == NULL)
+        return;
+
+    if (arena->current->previous != NULL)
+    {
+        size_t capacity = arena->capacity;
+        free_arena(arena);
+        add_arena_block(arena, capacity);
+        return;
+    }
+
+    arena->current->used = 0;
+}
+
+uint64_t hash_bytes(const char *data, int length)
+{
+    /*
+     * Hash key of group (FNV-1a), result is mixed so both low bits (slots) and high bits (partitions) are spread
+     *
+     * params:
+     * @data - bytes of key
+     * @length - length of key
+     *
+     * @return - hash of key
+     */
+
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+void init_group_table(GroupTable *table, int num_of_values, size_t memory_limit, int depth)
+{
+    /*
+     * Initialize empty table of groups
+     *
+     * params:
+     * @table - structure with table data
+     * @num_of_values - number of aggregated values of each group
+     * @memory_limit - memory of table after which groups are spilled to partition files
+     * @depth - level of spilling of groups in table (0 for groups of input rows)
+     */
+
+    memset(table, 0, sizeof(GroupTable));
+    table->num_of_values = num_of_values;
+    table->memory_limit = memory_limit;
+    table->depth = depth;
+}
+
+void clear_group_table(GroupTable *table)
+{
+    /*
+     * Release all groups of table, partition files are kept
+     *
+     * params:
+     * @table - structure with table data
+     */
+
+    free_arena(&table->arena);
+
+    free(table->groups);
+    table->groups = NULL;
+    table->num_of_groups = 0;
+    table->groups_capacity = 0;
+
+    free(table->slots);
+    table->slots = NULL;
+    table->num_of_slots = 0;
+}
+
+void free_group_table(GroupTable *table)
+{
+    /*
+     * Release groups of table and close its partition files
+     *
+     * params:
+     * @table - structure with table data
+     */
+
+    clear_group_table(table);
+
+    for (int i = 0; i < NUM_OF_SPILL_PARTITIONS; i++)
+    {
+        if (table->partitions[i] != NULL)
+            fclose(table->partitions[i]);
+    }
+
+    memset(table, 0, sizeof(GroupTable));
+}
+
+int is_group_table_full(const GroupTable *table)
+{
+    /*
+     * Check if table uses more memory than its limit, tables of last level of spilling are never full
+     *
+     * params:
+     * @table - structure with table data
+     *
+     * @return - 1 if groups of table should be spilled
+     *         - 0 if not
+     */
+
+    size_t memory = table->arena.capacity + sizeof(Group) * (size_t)table->groups_capacity + sizeof(int) * (size_t)table->num_of_slots;
+    return table->depth < MAX_SPILL_DEPTH && memory > table->memory_limit;
+}
+
+int grow_group_slots(GroupTable *table)
+{
+    /*
+     * Double number of slots of table and insert all groups to new slots
+     *
+     * params:
+     * @table - structure with table data
+     *
+     * @return - 0 on success
+     *         - -1 if memory cant be allocated
+     */
+
+    int num_of_slots = table->num_of_slots > 0 ? table->num_of_slots * 2 : MIN_GROUP_SLOTS;
+    int *slots = malloc(sizeof(int) * (size_t)num_of_slots);
+    if (slots == NULL)
+        return -1;
+
+    // All bytes set means -1 (empty slot)
+    memset(slots, 0xff, sizeof(int) * (size_t)num_of_slots);
+
+    int mask = num_of_slots - 1;
+    for (int i = 0; i < table->num_of_groups; i++)
+    {
+        int slot = (int)(table->groups[i].hash & (uint64_t)mask);
+        while (slots[slot] >= 0)
+            slot = (slot + 1) & mask;
+
+        slots[slot] = i;
+    }
+
+    free(table->slots);
+    table->slots = slots;
+    table->num_of_slots = num_of_slots;
+    return 0;
+}
+
+Group *get_group(GroupTable *table, const char *key, int key_len, uint64_t hash)
+{
+    /*
+     * Find group of key in table, group with empty values is added when key isnt in table yet
+     * Slots are probed linearly from slot given by low bits of hash
+     *
+     * params:
+     * @table - structure with table data
+     * @key - key of group (not terminated)
+     * @key_len - length of key
+     * @hash - hash of key
+     *
+     * @return - group of key
+     *         - NULL if memory cant be allocated
+     */
+
+    // Table is at most 3/4 full, so probing stops on empty slot soon
+    if (((long)table->num_of_groups + 1) * 4 > (long)table->num_of_slots * 3 && grow_group_slots(table) != 0)
+        return NULL;
+
+    int mask = table->num_of_slots - 1;
+    int slot = (int)(hash & (uint64_t)mask);
+    while (table->slots[slot] >= 0)
+    {
+        Group *group = &table->groups[table->slots[slot]];
+        if (group->hash == hash && group->key_len == key_len && memcmp(group->key, key, (size_t)key_len) == 0)
+            return group;
+
+        slot = (slot + 1) & mask;
+    }
+
+    if (table->num_of_groups == table->groups_capacity)
+    {
+        int capacity = table->groups_capacity > 0 ? table->groups_capacity * 2 : MIN_GROUP_SLOTS / 2;
+        Group *groups = realloc(table->groups, sizeof(Group) * (size_t)capacity);
+        if (groups == NULL)
+            return NULL;
+
+        table->groups = groups;
+        table->groups_capacity = capacity;
+    }
+
+    Group *group = &table->groups[table->num_of_groups];
+    group->key = arena_alloc(&table->arena, (size_t)key_len);
+    group->values = arena_alloc(&table->arena, sizeof(GroupValue) * (size_t)table->num_of_values);
+    if (group->key == NULL || group->values == NULL)
+        return NULL;
+
+    memcpy(group->key, key, (size_t)key_len);
+    memset(group->values, 0, sizeof(GroupValue) * (size_t)table->num_of_values);
+    group->key_len = key_len;
+    group->hash = hash;
+
+    table->slots[slot] = table->num_of_groups++;
+    return group;
+}
+
+void merge_group_value(GroupValue *value, const GroupValue *other)
+{
+    /*
+     * Add aggregated value of other part of group to value
+     *
+     * params:
+     * @value - value of group
+     * @other - value of same column in other part of group
+     */
+
+    if (other->count > 0)
+    {
+        if (value->count == 0 || other->min < value->min)
+            value->min = other->min;
+        if (value->count == 0 || other->max > value->max)
+            value->max = other->max;
+
+        value->sum += other->sum;
+        value->count += other->count;
+    }
+
+    value->nonempty += other->nonempty;
+}
+
+int spill_groups(GroupTable *table)
+{
+    /*
+     * Write all groups of table to partition files chosen by bits of their hashes and release them from memory
+     * Record of group is length of key, key and values of group
+     *
+     * params:
+     * @table - structure with table data
+     *
+     * @return - NO_ERROR on success
+     *         - OUTPUT_ERROR if partition file cant be created or written
+     */
+
+    int shift = 64 - SPILL_PARTITION_BITS * (table->depth + 1);
+    size_t num_of_values = (size_t)table->num_of_values;
+
+    for (int i = 0; i < table->num_of_groups; i++)
+    {
+        const Group *group = &table->groups[i];
+        int partition = (int)((group->hash >> shift) & (NUM_OF_SPILL_PARTITIONS - 1));
+
+        if (table->partitions[partition] == NULL && (table->partitions[partition] = tmpfile()) == NULL)
+            return OUTPUT_ERROR;
+
+        FILE *file = table->partitions[partition];
+        if (fwrite(&group->key_len, sizeof(int), 1, file) != 1 ||
+            fwrite(group->key, 1, (size_t)group->key_len, file) != (size_t)group->key_len ||
+            fwrite(group->values, sizeof(GroupValue), num_of_values, file) != num_of_values)
+            return OUTPUT_ERROR;
+    }
+
+    table->spilled = 1;
+    clear_group_table(table);
+    return NO_ERROR;
+}
+
+int load_group_partition(GroupTable *table, FILE *partition)
+{
+    /*
+     * Merge spilled groups from partition file to table
+     * Table is spilled to its own partitions when it gets full
+     *
+     * params:
+     * @table - structure with table data
+     * @partition - partition file with records of groups
+     *
+     * @return - NO_ERROR on success
+     *         - INPUT_ERROR if partition cant be read or memory cant be allocated
+     *         - OUTPUT_ERROR if table cant be spilled
+     */
+
+    char *key = NULL;
+    int key_capacity = 0;
+    int key_len;
+    // Groups of groupby without aggregates dont have values
+    GroupValue *values = NULL;
+    if (table->num_of_values > 0 && (values = malloc(sizeof(GroupValue) * (size_t)table->num_of_values)) == NULL)
+    {
+        fprintf(stderr, "Cant allocate memory for groups\n");
+        return INPUT_ERROR;
+    }
+
+    int error_flag = NO_ERROR;
+    rewind(partition);
+
+    while (error_flag == NO_ERROR && fread(&key_len, sizeof(int), 1, partition) == 1)
+    {
+        if (key_len >= key_capacity)
+        {
+            char *new_key = realloc(key, (size_t)key_len + 1);
+            if (new_key == NULL)
+            {
+                fprintf(stderr, "Cant allocate memory for groups\n");
+                error_flag = INPUT_ERROR;
+                break;
+            }
+
+            key = new_key;
+            key_capacity = key_len + 1;
+        }
+
+        if (fread(key, 1, (size_t)key_len, partition) != (size_t)key_len ||
+            (values != NULL && fread(values, sizeof(GroupValue), (size_t)table->num_of_values, partition) != (size_t)table->num_of_values))
+        {
+            fprintf(stderr, "Cant read temporary file of groups\n");
+            error_flag = INPUT_ERROR;
+            break;
+        }
+
+        Group *group = get_group(table, key, key_len, hash_bytes(key, key_len));
+        if (group == NULL)
+        {
+            fprintf(stderr, "Cant allocate memory for groups\n");
+            error_flag = INPUT_ERROR;
+            break;
+        }
+
+        for (int i = 0; i < table->num_of_values; i++)
+            merge_group_value(&group->values[i], &values[i]);
+
+        if (is_group_table_full(table) && spill_groups(table) != NO_ERROR)
+        {
+            fprintf(stderr, "Cant write temporary file of groups\n");
+            error_flag = OUTPUT_ERROR;
+        }
+    }
+
+    if (error_flag == NO_ERROR && ferror(partition))
+    {
+        fprintf(stderr, "Cant read temporary file of groups\n");
+        error_flag = INPUT_ERROR;
+    }
+
+    free(key);
+    free(values);
+    return error_flag;
+}
+
+void report_line_error(Line *line, int error_code, const char *format, ...)
+{
+    /*
+     * Set error flag of line and append formated message to error message of line
+     *
+     * params:
+     * @line - structure with line data
+     * @error_code - error code to set
+     * @format - printf like format string of message
+     */
+
+    size_t length = strlen(line->error_message);
+
+    if (length < ERROR_MESSAGE_LEN - 1)
+    {
+        va_list args;
+        va_start(args, format);
+        vsnprintf(line->error_message + length, ERROR_MESSAGE_LEN - length, format, args);
+        va_end(args);
+    }
+
+    line->error_flag = error_code;
+}
+
+void report_line_memory_error(Line *line)
+{
+    /*
+     * Report that memory for content of line cant be allocated
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    report_line_error(line, MAX_LINE_LEN_EXCEDED, "\nLine %d cant be stored, memory cant be allocated\n", line->line_index + 1);
+}
+
+int get_line_capacity(int length)
+{
+    /*
+     * Get size of buffer for line content of passed length with free space for edits
+     *
+     * params:
+     * @length - length of content
+     *
+     * @return - size of buffer
+     */
+
+    return length + length / 2 + MIN_LINE_GAP;
+}
+
+int copy_line_to_arena(Line *line)
+{
+    /*
+     * Copy content of line loaded from input to arena of line, so other delims can be replaced in the copy
+     * Input isnt written, mapped file stays read only and its pages are not copied to private memory
+     *
+     * params:
+     * @line - structure with line data
+     *
+     * @return - 0 on success
+     *         - -1 if memory cant be allocated
+     */
+
+    char *copy = arena_alloc(&line->arena, (size_t)line->line_len);
+    if (copy == NULL)
+        return -1;
+
+    memcpy(copy, line->line_string, line->line_len);
+    line->line_string = copy;
+    return 0;
+}
+
+void normalize_line(Line *line)
+{
+    /*
+     * Replace other delims in line loaded from input by main delim
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    if (line->normalized)
+        return;
+
+    line->normalized = 1;
+    if (line->delim_set->num_of_others == 0)
+        return;
+
+    if (copy_line_to_arena(line) != 0)
+    {
+        report_line_memory_error(line);
+        return;
+    }
+
+    line->delim_set->scan(line->line_string, line->line_len, line->delim_set, 1, NULL);
+}
+
+void index_line_delims(Line *line)
+{
+    /*
+     * Build index of delim positions in line string
+     * Line loaded from input is normalized in the same pass
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    // Every char of line can be delim
+    int capacity = get_line_capacity(line->line_len);
+    int normalize = !line->normalized && line->delim_set->num_of_others > 0;
+    line->delim_positions = arena_alloc(&line->arena, sizeof(int) * (size_t)capacity);
+    if (line->delim_positions == NULL || (normalize && copy_line_to_arena(line) != 0))
+    {
+        report_line_memory_error(line);
+        line->delims_capacity = line->delims_gap_start = line->delims_gap_end = line->num_of_delims = 0;
+        return;
+    }
+
+    line->num_of_delims = line->delim_set->scan(line->line_string, line->line_len, line->delim_set,
+                                                normalize, line->delim_positions);
+    line->delims_capacity = capacity;
+    line->delims_gap_start = line->num_of_delims;
+    line->delims_gap_end = capacity;
+    line->normalized = 1;
+}
+
+void prepare_delim_index(Line *line)
+{
+    /*
+     * Build index of delims if its not built for current content of line
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    if (line->num_of_delims < 0)
+        index_line_delims(line);
+}
+
+void invalidate_cell_values(Line *line)
+{
+    /*
+     * Start new generation of line content, so parsed values of all cells are invalid
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    if (++line->generation == 0)
+    {
+        // Values from old generations would be valid again after overflow
+        for (int i = 0; i < line->cell_values_capacity; i++)
+            line->cell_values[i].generation = 0;
+
+        line->generation = 1;
+    }
+}
+
+void invalidate_cell_value(Line *line, int index)
+{
+    /*
+     * Invalidate parsed value of edited cell
+     * Missing cells of row with less cells than expected overlap other cells, so all values are invalidated
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of cell
+     */
+
+    if (line->num_of_delims + 1 != line->final_cols)
+    {
+        invalidate_cell_values(line);
+        return;
+    }
+
+    if (index >= 0 && index < line->cell_values_capacity)
+        line->cell_values[index].generation = 0;
+
+    if (index >= line->aggregates.first_cell && index <= line->aggregates.last_cell)
+        line->aggregates.generation = 0;
+}
+
+void set_line_string(Line *line, char *string, int length)
+{
+    /*
+     * Set content of line without copying it
+     * Index of delims is built later when some cell is accessed
+     * Buffers of previous content are released
+     *
+     * params:
+     * @line - structure with line data
+     * @string - new content of line (dont have to be terminated)
+     * @length - length of new content
+     */
+
+    reset_arena(&line->arena);
+    invalidate_cell_values(line);
+    line->edit_buffer = NULL;
+    line->edit_capacity = 0;
+    line->delim_positions = NULL;
+    line->delims_capacity = 0;
+
+    line->line_string = string;
+    line->line_len = length;
+    line->edited = 0;
+    line->num_of_delims = -1;
+    line->normalized = 1;
+}
+
+void load_line_string(Line *line, char *string, int length)
+{
+    /*
+     * Set content of line from input data
+     * Other delims are replaced later together with building index of delims or before printing
+     *
+     * params:
+     * @line - structure with line data
+     * @string - line from input (dont have to be terminated)
+     * @length - length of line
+     */
+
+    set_line_string(line, string, length);
+    line->normalized = 0;
+}
+
+int make_line_editable(Line *line)
+{
+    /*
+     * Copy content of line to edit buffer before first edit of line
+     * Lines that are not edited are never copied
+     *
+     * params:
+     * @line - structure with line data
+     *
+     * @return - 0 on success
+     *         - -1 if memory cant be allocated (error flag is set)
+     */
+
+    if (line->edited)
+        return 0;
+
+    // Index is built before copy, positions of delims stay same because whole line is before gap
+    prepare_delim_index(line);
+
+    int capacity = get_line_capacity(line->line_len);
+    char *buffer = arena_alloc(&line->arena, (size_t)capacity);
+    if (buffer == NULL)
+    {
+        report_line_memory_error(line);
+        return -1;
+    }
+
+    memcpy(buffer, line->line_string, line->line_len);
+    line->edit_buffer = buffer;
+    line->edit_capacity = capacity;
+    line->gap_start = line->line_len;
+    line->gap_end = capacity;
+    line->edited = 1;
+    return 0;
+}
+
+void clear_line_string(Line *line)
+{
+    /*
+     * Set content of line to empty string
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    invalidate_cell_values(line);
+
+    line->line_len = 0;
+    line->edited = 1;
+    line->normalized = 1;
+    line->gap_start = 0;
+    line->gap_end = line->edit_capacity;
+
+    line->num_of_delims = 0;
+    line->delims_gap_start = 0;
+    line->delims_gap_end = line->delims_capacity;
+}
+
+void move_gap(Line *line, int position)
+{
+    /*
+     * Move gap in edit buffer before character of passed position
+     * Only text between old and new position of gap is moved
+     *
+     * params:
+     * @line - structure with line data
+     * @position - position in line string
+     */
+
+    int gap_length = line->gap_end - line->gap_start;
+
+    if (position < line->gap_start)
+    {
+        // Text in front of gap is moved behind it
+        int moved = line->gap_start - position;
+        memmove(&line->edit_buffer[line->gap_end - moved], &line->edit_buffer[position], moved);
+
+        while (line->delims_gap_start > 0 && line->delim_positions[line->delims_gap_start - 1] >= position)
+            line->delim_positions[--line->delims_gap_end] = line->delim_positions[--line->delims_gap_start] + gap_length;
+    }
+    else if (position > line->gap_start)
+    {
+        // Text behind gap is moved in front of it
+        int moved = position - line->gap_start;
+        memmove(&line->edit_buffer[line->gap_start], &line->edit_buffer[line->gap_end], moved);
+
+        while (line->delims_gap_end < line->delims_capacity && line->delim_positions[line->delims_gap_end] < line->gap_end + moved)
+            line->delim_positions[line->delims_gap_start++] = line->delim_positions[line->delims_gap_end++] - gap_length;
+    }
+
+    line->gap_start = position;
+    line->gap_end = position + gap_length;
+}
+
+int reserve_line_space(Line *line, int insert_length)
+{
+    /*
+     * Make sure that gap of edit buffer and gap of index of delims have space for inserted characters
+     * Buffer with small gap is replaced by larger buffer from arena of line, gap stays at the same position
+     *
+     * params:
+     * @line - structure with line data (line must be editable)
+     * @insert_length - number of characters to insert
+     *
+     * @return - 0 if insert fits to line
+     *         - -1 if memory cant be allocated (error flag is set)
+     */
+
+    if (line->gap_end - line->gap_start < insert_length)
+    {
+        int capacity = get_line_capacity(line->line_len + insert_length);
+        char *buffer = arena_alloc(&line->arena, (size_t)capacity);
+        if (buffer == NULL)
+        {
+            report_line_memory_error(line);
+            return -1;
+        }
+
+        // Text behind gap is moved to end of new buffer
+        int back_length = line->edit_capacity - line->gap_end;
+        if (line->gap_start > 0)
+            memcpy(buffer, line->edit_buffer, line->gap_start);
+        if (back_length > 0)
+            memcpy(buffer + capacity - back_length, &line->edit_buffer[line->gap_end], back_length);
+
+        // Delims behind gap are saved with position in edit buffer
+        for (int i = line->delims_gap_end; i < line->delims_capacity; i++)
+            line->delim_positions[i] += capacity - line->edit_capacity;
+
+        line->edit_buffer = buffer;
+        line->gap_end = capacity - back_length;
+        line->edit_capacity = capacity;
+    }
+
+    // Every inserted char can be delim
+    if (line->delims_gap_end - line->delims_gap_start < insert_length)
+    {
+        int capacity = get_line_capacity(line->num_of_delims + insert_length);
+        int *positions = arena_alloc(&line->arena, sizeof(int) * (size_t)capacity);
+        if (positions == NULL)
+        {
+            report_line_memory_error(line);
+            return -1;
+        }
+
+        int back_length = line->delims_capacity - line->delims_gap_end;
+        if (line->delims_gap_start > 0)
+            memcpy(positions, line->delim_positions, sizeof(int) * (size_t)line->delims_gap_start);
+        if (back_length > 0)
+            memcpy(positions + capacity - back_length, &line->delim_positions[line->delims_gap_end], sizeof(int) * (size_t)back_length);
+
+        line->delim_positions = positions;
+        line->delims_gap_end = capacity - back_length;
+        line->delims_capacity = capacity;
+    }
+
+    return 0;
+}
+
+void copy_line_range(Line *line, int start, int length, char *destination)
+{
+    /*
+     * Copy part of line string to other buffer
+     *
+     * params:
+     * @line - structure with line data
+     * @start - position of first copied character
+     * @length - number of copied characters
+     * @destination - output buffer
+     */
+
+    if (!line->edited)
+    {
+        memcpy(destination, &line->line_string[start], length);
+        return;
+    }
+
+    // Part in front of gap
+    int front_length = 0;
+    if (start < line->gap_start)
+    {
+        front_length = line->gap_start - start;
+        if (front_length > length)
+            front_length = length;
+
+        memcpy(destination, &line->edit_buffer[start], front_length);
+    }
+
+    // Part behind gap
+    if (front_length < length)
+    {
+        int gap_length = line->gap_end - line->gap_start;
+        memcpy(destination + front_length, &line->edit_buffer[start + front_length + gap_length], length - front_length);
+    }
+}
+
+int get_number_of_cells(Line *line)
+{
+    /*
+     * Get number of cells in row
+     * Cell is substring separated by deliminator
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    prepare_delim_index(line);
+    return line->num_of_delims + 1;
+}
+
+int get_delim_position(Line *line, int index)
+{
+    /*
+     * Get position of delim of certain index in line string
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of occurence of delim in line string
+     *
+     * @return - position of delim if found else -1
+     */
+
+    prepare_delim_index(line);
+    if (index > (line->num_of_delims - 1) || index < 0) return -1;
+
+    if (index < line->delims_gap_start)
+        return line->delim_positions[index];
+
+    // Delims behind gap are saved with position in edit buffer
+    return line->delim_positions[index + line->delims_gap_end - line->delims_gap_start] - (line->gap_end - line->gap_start);
+}
+
+int get_start_of_substring(Line *line, int index)
+{
+    /*
+     * Get start index of substring from line string limited by delim
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of substring in line
+     *
+     * @return - index of first char of substring if found
+     *         - -1 on error
+     */
+
+    if (index < 0 || index > line->final_cols)
+        return -1;
+
+    if (index == 0)
+    {
+        // if we want first substring there is no delim before substring then we are starting from first char of string
+        return 0;
+    }
+    else
+    {
+        // first character of substring after start delim
+        return get_delim_position(line, index - 1) + 1;
+    }
+}
+
+int get_end_of_substring(Line *line, int index)
+{
+    /*
+     * Get last index of substring from line string limited by delim
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of substring in line
+     *
+     * @return - index of last char of substring if found
+     *         - -1 on error
+     */
+
+    if (index > (line->final_cols - 1))
+        return -1;
+
+    if (index >= (line->final_cols - 1))
+    {
+        // if we are on the last cell we are going to the end of that line to the index of last char
+        return line->line_len - 1;
+    }
+    else
+    {
+        // last character of substring before delim
+        // position of delim - 1
+        return get_delim_position(line, index) - 1;
+    }
+}
+
+int get_cell_range(Line *line, int index, int *start, int *length)
+{
+    /*
+     * Find position and length of cell in line string
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of cell
+     * @start - output position of first char of cell
+     * @length - output length of cell
+     *
+     * @return - 0 on success
+     *         - -1 on error
+     */
+
+    // Check if index of cell is valid
+    if (index > (line->final_cols - 1) || index < 0)
+        return -1;
+
+    prepare_delim_index(line);
+
+    // Get indexes of substring
+    int start_index = get_start_of_substring(line, index);
+    int end_index = get_end_of_substring(line, index);
+
+    // If both indexes are bad then its error
+    if (start_index < 0 && end_index < 0)
+        return -1;
+
+    // if start index is 0 and end index is -1 it means its first cell in row and its empty
+    // then its not problem only it needs to set substring to empty string
+    if (start_index == 0 && end_index == -1)
+    {
+        *start = 0;
+        *length = 0;
+        return 0;
+    }
+
+    // Check if length is valid (only for case when the cell of inputed index doesnt exist)
+    if (end_index - start_index + 1 < 0)
+        return -1;
+
+    *start = start_index;
+    *length = end_index - start_index + 1;
+    return 0;
+}
+
+char *get_value_of_cell(Line *line, int index)
+{
+    /*
+     * Extract value of cell to terminated string allocated from arena of line
+     * Value stays valid until next row is loaded
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of cell
+     *
+     * @return - value of cell
+     *         - NULL on error
+     */
+
+    int start, length;
+    if (get_cell_range(line, index, &start, &length) != 0)
+        return NULL;
+
+    char *value = arena_alloc(&line->arena, (size_t)length + 1);
+    if (value == NULL)
+    {
+        report_line_memory_error(line);
+        return NULL;
+    }
+
+    copy_line_range(line, start, length, value);
+    value[length] = 0;
+
+    return value;
+}
+
+char *get_cell_span(Line *line, int index, int *length)
+{
+    /*
+     * Get pointer to content of cell in line without copying it
+     * Gap of edited line is moved out of the cell when cell is split by it
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of cell
+     * @length - output length of cell
+     *
+     * @return - pointer to first char of cell (cell is not terminated)
+     *         - NULL on error
+     */
+
+    int start;
+    if (get_cell_range(line, index, &start, length) != 0)
+        return NULL;
+
+    if (!line->edited)
+        return &line->line_string[start];
+
+    if (start < line->gap_start && start + *length > line->gap_start)
+        move_gap(line, start);
+
+    if (start < line->gap_start)
+        return &line->edit_buffer[start];
+
+    return &line->edit_buffer[start + line->gap_end - line->gap_start];
+}
+
+int check_line_sanity(Line *line)
+{
+    /*
+     * Check if line can be processed
+     * Length of line and cells is not limited, only line with error is not processed
+     *
+     * params:
+     * @line - structure with line data
+     *
+     * @return - 1 if line is ok
+     *         - 0 on fail
+     */
+
+    return !line->error_flag;
+}
+
+int string_to_double_slow(char *string, double *val)
+{
+    /*
+     * Convert string to double by strtod
+     *
+     * params:
+     * @string - string to convertion
+     * @val - output double value
+     *
+     * @return - 0 if conversion is success
+     *         - -1 if whole string is not double
+     */
+
+    // Pointer to unprocessed part of string
+    char *rest;
+    (*val) = strtod(string, &rest);
+
+    // If rest of string is not empty then string cant be converted to double
+    if (rest[0] != 0)
+        return -1;
+
+    return 0;
+}
+
+int string_to_double(char *string, double *val)
+{
+    /*
+     * Check if input string could be double and convert it to double in one pass
+     * Decimal numbers are validated here (same strings as strtod accepts) and converted exactly
+     * when mantissa and power of ten fit to double (Clinger's fast path), other numbers and formats
+     * (leading spaces, inf, nan, hexadecimal) are converted by strtod
+     *
+     * params:
+     * @string - string to convertion
+     * @val - output double value
+     *
+     * @return - 0 if conversion is success
+     *         - -1 if whole string is not double
+     */
+
+    // we dont want to convert empty strings to 0
+    if (string[0] == 0)
+        return -1;
+
+    const char *pos = string;
+    int negative = 0;
+
+    if (*pos == '+' || *pos == '-')
+    {
+        negative = *pos == '-';
+        pos++;
+    }
+
+    if (!(isdigit((unsigned char)*pos) || *pos == '.') || (pos[0] == '0' && (pos[1] == 'x' || pos[1] == 'X')))
+        return string_to_double_slow(string, val);
+
+    uint64_t mantissa = 0;
+    int significant_digits = 0, digits = 0, exponent = 0, truncated = 0;
+
+    // Integer part
+    for (; isdigit((unsigned char)*pos); pos++, digits++)
+    {
+        int digit = *pos - '0';
+
+        // Skip leading zeros
+        if (mantissa == 0 && digit == 0)
+            continue;
+
+        if (significant_digits < 19)
+        {
+            mantissa = mantissa * 10 + digit;
+            significant_digits++;
+        }
+        else
+        {
+            exponent++;
+            truncated |= digit != 0;
+        }
+    }
+
+    // Fraction part
+    if (*pos == '.')
+    {
+        for (pos++; isdigit((unsigned char)*pos); pos++, digits++)
+        {
+            int digit = *pos - '0';
+
+            if (mantissa == 0 && digit == 0)
+            {
+                exponent--;
+                continue;
+            }
+
+            if (significant_digits < 19)
+            {
+                mantissa = mantissa * 10 + digit;
+                significant_digits++;
+                exponent--;
+            }
+            else
+            {
+                truncated |= digit != 0;
+            }
+        }
+    }
+
+    // Number without digits is not number
+    if (digits == 0)
+        return -1;
+
+    // Exponent is used only if there is at least one digit after it (same as strtod)
+    if (*pos == 'e' || *pos == 'E')
+    {
+        const char *exponent_pos = pos + 1;
+        int exponent_negative = 0;
+
+        if (*exponent_pos == '+' || *exponent_pos == '-')
+        {
+            exponent_negative = *exponent_pos == '-';
+            exponent_pos++;
+        }
+
+        if (isdigit((unsigned char)*exponent_pos))
+        {
+            int exponent_value = 0;
+            for (; isdigit((unsigned char)*exponent_pos); exponent_pos++)
+            {
+                if (exponent_value < 100000)
+                    exponent_value = exponent_value * 10 + (*exponent_pos - '0');
+            }
+
+            exponent += exponent_negative ? -exponent_value : exponent_value;
+            pos = exponent_pos;
+        }
+    }
+
+    // If rest of string is not empty then string cant be converted to double
+    if (*pos != 0)
+        return -1;
+
+    if (!truncated && mantissa <= MAX_EXACT_DOUBLE_INT)
+    {
+        double value = (double)mantissa;
+        int fast_path = 1;
+
+        if (mantissa == 0 || exponent == 0)
+            ;
+        else if (exponent < 0 && exponent >= -MAX_EXACT_POWER_OF_TEN)
+            value /= EXACT_POWERS_OF_TEN[-exponent];
+        else if (exponent > 0 && exponent <= MAX_EXACT_POWER_OF_TEN)
+            value *= EXACT_POWERS_OF_TEN[exponent];
+        else if (exponent > MAX_EXACT_POWER_OF_TEN && exponent <= MAX_EXACT_POWER_OF_TEN + 15 &&
+                 value * EXACT_POWERS_OF_TEN[exponent - MAX_EXACT_POWER_OF_TEN] <= (double)MAX_EXACT_DOUBLE_INT)
+            // Part of exponent is moved to mantissa while it stays exact
+            value = value * EXACT_POWERS_OF_TEN[exponent - MAX_EXACT_POWER_OF_TEN] * EXACT_POWERS_OF_TEN[MAX_EXACT_POWER_OF_TEN];
+        else
+            fast_path = 0;
+
+        if (fast_path)
+        {
+            (*val) = negative ? -value : value;
+            return 0;
+        }
+    }
+
+    // Valid number that cant be converted exactly here
+    return string_to_double_slow(string, val);
+}
+
+int is_string_int(char *string)
+{
+    /*
+     * Check if input string is intiger
+     *
+     * params:
+     * @string - string to convertion
+     *
+     * @return - 1 if is intiger
+     *         - 0 if not
+     */
+
+    if (string[0] == 0)
+        return 0;
+
+    // Pointer to unprocessed part of string
+    char *rest;
+    strtol(string, &rest, 10);
+
+    if (rest[0] != 0)
+        return 0;
+
+    return 1;
+}
+
+int string_to_int(char *string, int *val)
+{
+    /*
+     * Try to convert string to int
+     *
+     * params:
+     * @string - string to convertion
+     * @val - output intiger value
+     *
+     * @return - 0 if conversion is success
+     *         - -1 if whole string is not int
+     */
+
+    // we dont want to convert empty strings to 0
+    if (string[0] == 0)
+        return -1;
+
+    // Pointer to unprocessed part of string
+    char *rest;
+    (*val) = (int)strtol(string, &rest, 10);
+
+    // If rest of string is not empty then string cant be converted to int
+    if (rest[0] != 0)
+        return -1;
+
+    return 0;
+}
+
+int is_double_int(double val)
+{
+    /*
+     * Check if double could be converted to int without loss of precision
+     *
+     * params:
+     * @val - double value to check
+     *
+     * @return - 1 if it could be converted without loss of precision
+     *         - 0 if couldnt
+     */
+
+    if (val == 0) return 1;
+    return (int)(val) == val;
+}
+
+int int_to_string(int val, char *buffer)
+{
+    /*
+     * Format int to decimal string (same output as %d)
+     *
+     * params:
+     * @val - int value to format
+     * @buffer - output buffer, must have at least 12 characters
+     *
+     * @return - length of formated string
+     */
+
+    char digits[12];
+    int num_of_digits = 0;
+    int length = 0;
+    // Unsigned negation is defined for INT_MIN too
+    unsigned int abs_val = (val < 0) ? 0u - (unsigned int)val : (unsigned int)val;
+
+    do
+    {
+        digits[num_of_digits++] = (char)('0' + abs_val % 10);
+        abs_val /= 10;
+    } while (abs_val != 0);
+
+    if (val < 0)
+        buffer[length++] = '-';
+
+    while (num_of_digits > 0)
+        buffer[length++] = digits[--num_of_digits];
+
+    buffer[length] = 0;
+    return length;
+}
+
+int double_to_string(double val, char *buffer)
+{
+    /*
+     * Format double to decimal string with fixed number of decimal places (same output as %lf)
+     * Value is scaled to integer number of millionths exactly in 128bit integer and rounded half to even
+     * like printf does, values too big for this are formated by snprintf
+     *
+     * params:
+     * @val - double value to format
+     * @buffer - output buffer, must have at least MAX_NUMBER_LEN + 1 characters
+     *
+     * @return - length of formated string
+     */
+
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+
+    int negative = (int)(bits >> 63);
+    int exponent = (int)((bits >> 52) & 0x7FF);
+    uint64_t mantissa = bits & ((1ULL << 52) - 1);
+
+    // Infinity, NaN and values which scaled dont fit to 64bit integer
+    if (exponent == 0x7FF || exponent > 1023 + 43)
+    {
+        int length = snprintf(buffer, MAX_NUMBER_LEN + 1, "%lf", val);
+        return (length > MAX_NUMBER_LEN) ? MAX_NUMBER_LEN : length;
+    }
+
+    // val = mantissa * 2^exponent
+    if (exponent == 0)
+        exponent = 1 - 1075;
+    else
+    {
+        mantissa |= 1ULL << 52;
+        exponent -= 1075;
+    }
+
+    // Number of millionths, mantissa * 10^6 < 2^73 so it fits to 128bits
+    unsigned __int128 scaled = (unsigned __int128)mantissa * FORMAT_DECIMALS_SCALE;
+    uint64_t millionths;
+
+    // Values are smaller than 2^44 here so exponent is always negative
+    if (exponent < -73)
+        millionths = 0; // Less than half of millionth
+    else
+    {
+        int shift = -exponent;
+        unsigned __int128 remainder = scaled & ((((unsigned __int128)1) << shift) - 1);
+        unsigned __int128 half = ((unsigned __int128)1) << (shift - 1);
+
+        millionths = (uint64_t)(scaled >> shift);
+        if (remainder > half || (remainder == half && (millionths & 1)))
+            millionths++;
+    }
+
+    uint64_t int_part = millionths / FORMAT_DECIMALS_SCALE;
+    uint64_t frac_part = millionths % FORMAT_DECIMALS_SCALE;
+    char digits[24];
+    int num_of_digits = 0;
+    int length = 0;
+
+    do
+    {
+        digits[num_of_digits++] = (char)('0' + int_part % 10);
+        int_part /= 10;
+    } while (int_part != 0);
+
+    // Sign is printed even for values rounded to zero
+    if (negative)
+        buffer[length++] = '-';
+
+    while (num_of_digits > 0)
+        buffer[length++] = digits[--num_of_digits];
+
+    buffer[length++] = '.';
+    for (int i = FORMAT_DECIMALS - 1; i >= 0; i--)
+    {
+        buffer[length + i] = (char)('0' + frac_part % 10);
+        frac_part /= 10;
+    }
+    length += FORMAT_DECIMALS;
+
+    buffer[length] = 0;
+    return length;
+}
+
+int number_to_string(double val, char *buffer)
+{
+    /*
+     * Format computed value of cell, values without decimal part are formated as int
+     *
+     * params:
+     * @val - value to format
+     * @buffer - output buffer, must have at least MAX_NUMBER_LEN + 1 characters
+     *
+     * @return - length of formated string
+     */
+
+    if (is_double_int(val))
+        return int_to_string((int)val, buffer);
+
+    return double_to_string(val, buffer);
+}
+
+void string_conversion(char *string, int conversion_flag)
+{
+    /*
+     * Converts string based on selected functions
+     * Supported functions: UPPER - string to uppercase
+     *                      LOWER - string to lowercase
+     *
+     * params:
+     * @string - input string
+     * @conversion_flag - flag to select function
+     */
+
+    for (size_t i = 0; string[i]; i++)
+    {
+        // iterate over string
+        while (*string)
+        {
+            if ((*string >= 'a' && *string <= 'z') || (*string >= 'A' && *string <= 'Z'))
+            {
+                if (conversion_flag == UPPER)
+                    *string = (char)toupper(*string);
+                else if (conversion_flag == LOWER)
+                    *string = (char)tolower(*string);
+            }
+
+            string++;
+        }
+    }
+}
+
+int argument_to_int(char *input_array[], int array_len, int index)
+{
+    /*
+     * Try to convert argument to int
+     *
+     * params:
+     * @input_array - array with all arguments
+     * @array_len - lenght of array with arguments
+     * @index - index of argument we want convert to int
+     *
+     * @return - int value of argument
+     *         - on error 0
+     */
+
+    int val;
+
+    if (index >= array_len || string_to_int(input_array[index], &val) != 0)
+        return 0;
+
+    return val;
+}
+
+void generate_empty_row(Line *line)
+{
+    /*
+     * Create string with empty line format based on wanted line length and delim char
+     * Empty line is saved to line structure instead of current line string
+     * Line will have same number of cells as saved number of cells from first line
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    clear_line_string(line);
+
+    if (line->final_cols <= 0 || reserve_line_space(line, line->final_cols - 1) != 0)
+        return;
+
+    int i = 0;
+    for (; i < (line->final_cols - 1); i++)
+    {
+        line->edit_buffer[i] = line->delim;
+        line->delim_positions[i] = i;
+    }
+
+    line->line_len = line->gap_start = i;
+    line->num_of_delims = line->delims_gap_start = i;
+}
+
+int is_line_empty(Line *line)
+{
+    /*
+     * Check if currentl line is empty
+     * Line is empty when line is flagged as deleted or number of colms is 0
+     *
+     * params:
+     * @line - structure with line data
+     *
+     * @return - 1 if line is empty else 0
+     */
+
+    return (line->deleted || (line->final_cols == 0));
+}
+
+int init_output(OutputBuffer *output, int fd, size_t capacity)
+{
+    /*
+     * Allocate output buffer for file descriptor
+     *
+     * params:
+     * @output - structure with output buffer data
+     * @fd - file descriptor where output will be written, -1 for output kept in memory
+     * @capacity - initial size of buffer
+     *
+     * @return - NO_ERROR on success
+     *         - OUTPUT_ERROR if buffer cant be allocated
+     */
+
+    output->length = 0;
+    output->capacity = capacity;
+    output->fd = fd;
+    output->error_flag = NO_ERROR;
+
+    output->data = malloc(output->capacity);
+    if (output->data == NULL)
+    {
+        fprintf(stderr, "Cant allocate output buffer\n");
+        return OUTPUT_ERROR;
+    }
+
+    return NO_ERROR;
+}
+
+int write_all(int fd, const char *data, size_t length)
+{
+    /*
+     * Write whole data block to file descriptor
+     *
+     * params:
+     * @fd - output file descriptor
+     * @data - data to write
+     * @length - length of data
+     *
+     * @return - 0 on success
+     *         - -1 on error
+     */
+
+    while (length > 0)
+    {
+        ssize_t written = write(fd, data, length);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return -1;
+        }
+
+        data += written;
+        length -= (size_t)written;
+    }
+
+    return 0;
+}
+
+int flush_output(OutputBuffer *output)
+{
+    /*
+     * Write content of output buffer to its file descriptor and clear buffer
+     *
+     * params:
+     * @output - structure with output buffer data
+     *
+     * @return - NO_ERROR on success
+     *         - OUTPUT_ERROR when write failed
+     */
+
+    if (output->error_flag || output->fd < 0)
+        return output->error_flag;
+
+    if (output->length > 0 && write_all(output->fd, output->data, output->length) != 0)
+    {
+        fprintf(stderr, "Cant write output\n");
+        output->error_flag = OUTPUT_ERROR;
+    }
+
+    output->length = 0;
+    return output->error_flag;
+}
+
+int grow_output(OutputBuffer *output, size_t length)
+{
+    /*
+     * Enlarge output buffer kept in memory so it has space for more data
+     *
+     * params:
+     * @output - structure with output buffer data
+     * @length - length of data that have to fit to buffer
+     *
+     * @return - NO_ERROR on success
+     *         - OUTPUT_ERROR if buffer cant be enlarged
+     */
+
+    if (output->error_flag)
+        return output->error_flag;
+
+    size_t capacity = output->capacity * 2;
+    while (capacity - output->length < length)
+        capacity *= 2;
+
+    char *data = realloc(output->data, capacity);
+    if (data == NULL)
+    {
+        fprintf(stderr, "Cant allocate output buffer\n");
+        output->error_flag = OUTPUT_ERROR;
+        return OUTPUT_ERROR;
+    }
+
+    output->data = data;
+    output->capacity = capacity;
+    return NO_ERROR;
+}
+
+void write_to_output(OutputBuffer *output, const char *data, size_t length)
+{
+    /*
+     * Append data to output buffer, buffer is flushed when there is no space for data
+     *
+     * params:
+     * @output - structure with output buffer data
+     * @data - data to append
+     * @length - length of data
+     */
+
+    if (length > (output->capacity - output->length))
+    {
+        if (output->fd < 0)
+        {
+            if (grow_output(output, length) == NO_ERROR)
+            {
+                memcpy(output->data + output->length, data, length);
+                output->length += length;
+            }
+            return;
+        }
+
+        flush_output(output);
+
+        // Data that wouldnt fit to empty buffer are written directly
+        if (length > output->capacity)
+        {
+            if (!output->error_flag && write_all(output->fd, data, length) != 0)
+            {
+                fprintf(stderr, "Cant write output\n");
+                output->error_flag = OUTPUT_ERROR;
+            }
+            return;
+        }
+    }
+
+    memcpy(output->data + output->length, data, length);
+    output->length += length;
+}
+
+void write_char_to_output(OutputBuffer *output, char ch)
+{
+    /*
+     * Append single character to output buffer
+     *
+     * params:
+     * @output - structure with output buffer data
+     * @ch - character to append
+     */
+
+    if (output->length == output->capacity)
+    {
+        if (output->fd < 0)
+        {
+            if (grow_output(output, 1) != NO_ERROR)
+                return;
+        }
+        else
+            flush_output(output);
+    }
+
+    output->data[output->length++] = ch;
+}
+
+void print_to_output(OutputBuffer *output, const char *format, ...)
+{
+    /*
+     * Append formated string to output buffer
+     *
+     * params:
+     * @output - structure with output buffer data
+     * @format - printf like format string
+     */
+
+    char buffer[PRINT_BUFFER_SIZE];
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    if (length < 0)
+        return;
+
+    if ((size_t)length < sizeof(buffer))
+    {
+        write_to_output(output, buffer, (size_t)length);
+        return;
+    }
+
+    // Longer output is formated again to buffer of its size
+    char *long_buffer = malloc((size_t)length + 1);
+    if (long_buffer == NULL)
+    {
+        write_to_output(output, buffer, sizeof(buffer) - 1);
+        return;
+    }
+
+    va_start(args, format);
+    vsnprintf(long_buffer, (size_t)length + 1, format, args);
+    va_end(args);
+
+    write_to_output(output, long_buffer, (size_t)length);
+    free(long_buffer);
+}
+
+void free_output(OutputBuffer *output)
+{
+    /*
+     * Flush rest of output buffer and release it
+     *
+     * params:
+     * @output - structure with output buffer data
+     */
+
+    flush_output(output);
+    free(output->data);
+    output->data = NULL;
+}
+
+void write_line_to_output(Line *line)
+{
+    /*
+     * Write content of line to output buffer
+     * Edited line is written from both parts of edit buffer
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    if (line->edited)
+    {
+        // Empty line doesnt have to have edit buffer
+        if (line->line_len > 0)
+        {
+            write_to_output(line->output, line->edit_buffer, line->gap_start);
+            write_to_output(line->output, &line->edit_buffer[line->gap_end], line->edit_capacity - line->gap_end);
+        }
+    }
+    else
+    {
+        normalize_line(line);
+        write_to_output(line->output, line->line_string, line->line_len);
+    }
+
+    write_char_to_output(line->output, '\n');
+}
+
+#ifdef DEBUG
+void write_line_debug_prefix(Line *line)
+{
+    /*
+     * Write debug information before line data
+     * Numbers are formatted without printf, prefix is written for every line of output
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    char number[12];
+
+    write_to_output(line->output, "[Line debug] LI: ", 17);
+    write_to_output(line->output, number, (size_t)int_to_string(line->line_index, number));
+    write_to_output(line->output, ", FC: ", 6);
+    write_to_output(line->output, number, (size_t)int_to_string(line->final_cols, number));
+    write_to_output(line->output, ", PF: ", 6);
+    write_to_output(line->output, number, (size_t)int_to_string(line->process_flag, number));
+    write_to_output(line->output, " Line data:\t\t", 13);
+}
+#endif
+
+void pass_line(Line *line)
+{
+    /*
+     * Print line that is not edited directly from input data
+     * Cells are not parsed
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+#ifdef DEBUG
+    write_line_debug_prefix(line);
+#endif
+
+    write_line_to_output(line);
+    line->line_index++;
+}
+
+void print_line(Line *line)
+{
+    /*
+     * Print line and clear it from buffer
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    if (!is_line_empty(line))
+    {
+#ifdef DEBUG
+        write_line_debug_prefix(line);
+#endif
+
+        write_line_to_output(line);
+    }
+
+    line->line_index++;
+    clear_line_string(line);
+}
+
+void delete_line_content(Line *line)
+{
+    /*
+     * Delete line string and if line wasnt already empty switch delete flag to true
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    if (!is_line_empty(line))
+    {
+        clear_line_string(line);
+        line->deleted = 1;
+    }
+}
+
+void commit_gap_insert(Line *line, int insert_length)
+{
+    /*
+     * Take characters written to start of gap as part of line and add their delims to delim index
+     *
+     * params:
+     * @line - structure with line data
+     * @insert_length - number of characters written to start of gap
+     */
+
+    int pos = line->gap_start;
+    int num_of_delims = line->num_of_delims;
+
+    for (int i = 0; i < insert_length; ++i)
+    {
+        if (line->edit_buffer[pos + i] == line->delim)
+        {
+            line->delim_positions[line->delims_gap_start++] = pos + i;
+            line->num_of_delims++;
+        }
+    }
+
+    // Inserted delims shift following cells
+    if (line->num_of_delims != num_of_delims)
+        invalidate_cell_values(line);
+
+    line->gap_start += insert_length;
+    line->line_len += insert_length;
+}
+
+int insert_string_to_line(Line *line, char *insert_string, int index)
+{
+    /*
+     * Insert string to line string
+     *
+     * params:
+     * @line - structure with line data
+     * @insert_string - string that will be inserted to base_string
+     * @index - index of character from which insert_string will be inserted to base_string
+     *
+     * @return - 0 on success
+     *         - -1 on error
+     */
+
+    int insert_string_length = (int)strlen(insert_string);
+
+    if (make_line_editable(line) != 0 || reserve_line_space(line, insert_string_length) != 0)
+        return -1;
+
+    // If index is larger than basestring lenght then insert position is lenght of base string
+    int pos = (index < line->line_len) ? index : line->line_len;
+
+    // Inserted string is written to start of gap
+    move_gap(line, pos);
+    memcpy(&line->edit_buffer[pos], insert_string, insert_string_length);
+    commit_gap_insert(line, insert_string_length);
+    return 0;
+}
+
+int remove_substring(Line *line, int start_index, int end_index)
+{
+    /*
+     * Remove substring from line string base on input indexes
+     *
+     * params:
+     * @line - structure with line data
+     * @start_index - index of first removed char of substring
+     * @end_index - index of last removed char of substring
+     *
+     * @return - 0 on success
+     *         - -1 on error
+     */
+
+    if (start_index < 0 || end_index < 0 || start_index > end_index)
+        return -1;
+
+    if (end_index >= line->line_len)
+        end_index = line->line_len - 1;
+
+    if (start_index > end_index)
+        return 0;
+
+    if (make_line_editable(line) != 0)
+        return -1;
+
+    // Removed substring is joined to gap
+    move_gap(line, start_index);
+    int removed_chars = end_index - start_index + 1;
+
+    // Drop delims from removed substring, following cells are shifted
+    int num_of_delims = line->num_of_delims;
+    while (line->delims_gap_end < line->delims_capacity && line->delim_positions[line->delims_gap_end] < line->gap_end + removed_chars)
+    {
+        line->delims_gap_end++;
+        line->num_of_delims--;
+    }
+
+    if (line->num_of_delims != num_of_delims)
+        invalidate_cell_values(line);
+
+    line->gap_end += removed_chars;
+    line->line_len -= removed_chars;
+    return 0;
+}
+
+int insert_to_cell(Line *line, int index, char *string)
+{
+    /*
+     * Insert string to column
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of column to insert string
+     * @string - string that will be inserted to cell
+     *
+     * @return - 0 on success
+     *         - -1 on error
+     */
+
+    invalidate_cell_value(line, index);
+
+    // Get position of first character in cell
+    index = get_start_of_substring(line, index);
+    if (index < 0)
+        return -1;
+
+    // This will insert string BEFORE the index
+    return insert_string_to_line(line, string, index);
+}
+
+int insert_empty_cell(Line *line, int index)
+{
+    /*
+     * Insert new cell before the one selected by index
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of cell before which will be inserted new cell
+     *
+     * @return - 0 on success
+     *         - -1 on error
+     */
+
+    // When inserting to existing row of cells there is always delim
+    char empty_col[2] = {line->delim, '\0'};
+
+    // Insert string with delim in front of value in cell
+    int ret = insert_to_cell(line, index, empty_col);
+    if (ret == 0)
+    {
+        line->final_cols++;
+        invalidate_cell_values(line);
+    }
+
+    return ret;
+}
+
+void append_empty_cell(Line *line)
+{
+    /*
+     * Insert empty cell on the end of the line
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    invalidate_cell_values(line);
+
+    if (line->final_cols < 1)
+    {
+        line->final_cols++;
+        return;
+    }
+
+    line->final_cols++;
+
+    char empty_col[2] = {line->delim, '\0'};
+
+    // Insert new empty colm (length of line is checked)
+    insert_string_to_line(line, empty_col, line->line_len);
+}
+
+int remove_cell(Line *line, int index)
+{
+    /*
+     * Remove whole cell
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of cell to remove
+     *
+     * @return - 0 on success
+     *         - -1 on error
+     */
+
+    int start_index = get_start_of_substring(line, index);
+    // offset to delim in front of substring if there is any to delete it
+    if (index != 0 && (line->final_cols - 1) == index)
+        start_index -= 1;
+
+    // offset to delim char after the substring
+    int end_index = get_end_of_substring(line, index) + 1;
+    int ret = remove_substring(line, start_index, end_index);
+
+    if (ret == 0)
+    {
+        line->final_cols--;
+        invalidate_cell_values(line);
+    }
+
+    return ret;
+}
+
+int clear_cell(Line *line, int index)
+{
+    /*
+     * Clear value from cell
+     *
+     * param:
+     * @line - structure with line data
+     * @index - index of cell to clear
+     *
+     * @return - 0 on success
+     *         - -1 on error
+     */
+
+    if (index < 0)
+        return -1;
+
+    invalidate_cell_value(line, index);
+
+    int start_index = get_start_of_substring(line, index);
+    int end_index = get_end_of_substring(line, index);
+
+    if (start_index < 0 || end_index < 0)
+        return -1;
+
+    // Remove subring with value of cell
+    return remove_substring(line, start_index, end_index);
+}
+
+void init_selector(Selector *selector)
+{
+    /*
+     * Set selector to empty selector that selects every line
+     *
+     * params:
+     * @selector - structure to initialize
+     */
+
+    // Params that selector doesnt use stay empty
+    selector->selector_type = -1;
+    selector->a1 = NULL;
+    selector->a2 = NULL;
+    selector->str = NULL;
+    selector->ai1 = 0;
+    selector->ai2 = 0;
+    selector->searcher.automaton = NULL;
+    selector->regex = NULL;
+    selector->left = NULL;
+    selector->right = NULL;
+}
+
+void free_selector(Selector *selector)
+{
+    /*
+     * Release memory of selector and its operands
+     *
+     * params:
+     * @selector - structure with selector params
+     */
+
+    free_searcher(&selector->searcher);
+
+    if (selector->regex != NULL)
+        free_regex(selector->regex);
+
+    free(selector->regex);
+    selector->regex = NULL;
+
+    Selector *operands[2] = {selector->left, selector->right};
+    for (int i = 0; i < 2; i++)
+    {
+        if (operands[i] != NULL)
+            free_selector(operands[i]);
+
+        free(operands[i]);
+    }
+
+    selector->left = NULL;
+    selector->right = NULL;
+}
+
+int load_selector_leaf(Selector *selector, int argc, char *argv[], int i, int *num_of_regexes)
+{
+    /*
+     * Load single selector (rows, beginswith, contains, containsany, matches) with its arguments from position in arguments
+     *
+     * params:
+     * @selector - structure to save params for selector
+     * @argc - length of argument array
+     * @argv - argument array
+     * @i - position of selector name
+     * @num_of_regexes - number of regexes loaded before, used as id of regex
+     *
+     * @return - 1 if selector was loaded
+     *         - 0 if there is no valid selector at position
+     *         - -1 if patterns of selector cant be loaded
+     */
+
+    // Selector needs another 2 args after the selector flag
+    if (i >= (argc - 2))
+        return 0;
+
+    for (int j = 0; j < NUMBER_OF_SELECTOR_COMS; j++)
+    {
+        if (strcmp(argv[i], SELECTOR_COMS[j]) != 0)
+            continue;
+
+        switch (j)
+        {
+            case 0:
+                // rows selector is valid when both arguments are int > 0 and a1 < a2 or -
+                if (((argument_to_int(argv, argc, i+1) > 0) || strings_equal(argv[i + 1], "-")) &&
+                    ((argument_to_int(argv, argc, i+2) > 0) || strings_equal(argv[i + 2], "-")))
+                {
+                    if (is_string_int(argv[i+1]) && is_string_int(argv[i+2]) &&
+                        (argument_to_int(argv, argc, i+1) > argument_to_int(argv, argc, i+2)))
+                    {
+                        return 0;
+                    }
+
+                    selector->selector_type = j;
+                    selector->a1 = argv[i+1];
+                    selector->a2 = argv[i+2];
+                    selector->ai1 = argument_to_int(argv, argc, i+1);
+                    selector->ai2 = argument_to_int(argv, argc, i+2);
+                    return 1;
+                }
+                return 0;
+
+            default:
+                // Other selectors have cell index and string argument
+                if ((argument_to_int(argv, argc, i+1) <= 0) && !strings_equal(argv[i + 1], "-"))
+                    return 0;
+
+                selector->selector_type = j;
+                selector->a1 = argv[i+1];
+                selector->ai1 = argument_to_int(argv, argc, i+1);
+                selector->str = argv[i+2];
+                break;
+        }
+
+        switch (j)
+        {
+            case 3:
+                // containsany C FILE has patterns in file
+                return init_set_searcher(&selector->searcher, selector->str) == NO_ERROR ? 1 : -1;
+
+            case 4:
+                // matches C REGEX
+                selector->regex = malloc(sizeof(Regex));
+                if (selector->regex == NULL)
+                {
+                    fprintf(stderr, "Cant allocate memory for regex\n");
+                    return -1;
+                }
+
+                if (compile_regex(selector->regex, selector->str) != NO_ERROR)
+                    return -1;
+
+                // Every regex has its own cache in each line
+                selector->regex->id = (*num_of_regexes)++;
+                return 1;
+
+            default:
+                init_searcher(&selector->searcher, selector->str);
+                return 1;
+        }
+    }
+
+    return 0;
+}
+
+// selector_parsers
+/*
+ * Parse expression of selectors combined by operators from position in arguments
+ * Operator "not" binds strongest, then "and", then "or"
+ * Operator without valid selector after it is not part of expression
+ *
+ * params:
+ * @selector - structure to save parsed expression
+ * @argc - length of argument array
+ * @argv - argument array
+ * @position - position of expression, moved behind it
+ * @num_of_regexes - number of regexes loaded before
+ *
+ * @return - 1 if expression was loaded
+ *         - 0 if there is no valid expression at position
+ *         - -1 if patterns of some selector cant be loaded
+ */
+
+int parse_selector_factor(Selector *selector, int argc, char *argv[], int *position, int *num_of_regexes)
+{
+    // Consecutive "not"s are folded to one or none, so long chain of them doesnt make deep expression
+    int operand_position = *position;
+    int negated = 0;
+    while (operand_position < argc && strings_equal(argv[operand_position], "not"))
+    {
+        negated = !negated;
+        operand_position++;
+    }
+
+    Selector *operand = selector;
+    if (negated)
+    {
+        operand = malloc(sizeof(Selector));
+        if (operand == NULL)
+        {
+            fprintf(stderr, "Cant allocate memory for selector\n");
+            return -1;
+        }
+
+        init_selector(operand);
+    }
+
+    int result = load_selector_leaf(operand, argc, argv, operand_position, num_of_regexes);
+    if (result <= 0)
+    {
+        if (negated)
+        {
+            free_selector(operand);
+            free(operand);
+        }
+        return result;
+    }
+
+    if (negated)
+    {
+        selector->selector_type = SELECTOR_NOT;
+        selector->left = operand;
+    }
+
+    *position = operand_position + 3;
+    return result;
+}
+
+int parse_selector_operation(Selector *selector, int argc, char *argv[], int *position, int *num_of_regexes, int operator_type)
+{
+    // Operands of "or" are "and" operations, operands of "and" are factors
+    const char *operator_name = operator_type == SELECTOR_OR ? "or" : "and";
+    int result = operator_type == SELECTOR_OR ? parse_selector_operation(selector, argc, argv, position, num_of_regexes, SELECTOR_AND)
+                                              : parse_selector_factor(selector, argc, argv, position, num_of_regexes);
+
+    while (result > 0 && *position < argc && strings_equal(argv[*position], operator_name))
+    {
+        Selector *left = malloc(sizeof(Selector));
+        Selector *right = malloc(sizeof(Selector));
+        if (left == NULL || right == NULL)
+        {
+            fprintf(stderr, "Cant allocate memory for selector\n");
+            free(left);
+            free(right);
+            return -1;
+        }
+
+        init_selector(right);
+        int right_position = *position + 1;
+        int right_result = operator_type == SELECTOR_OR ? parse_selector_operation(right, argc, argv, &right_position, num_of_regexes, SELECTOR_AND)
+                                                        : parse_selector_factor(right, argc, argv, &right_position, num_of_regexes);
+        if (right_result <= 0)
+        {
+            free_selector(right);
+            free(right);
+            free(left);
+            return right_result < 0 ? -1 : 1;
+        }
+
+        // Expression parsed so far becomes left operand
+        *left = *selector;
+        init_selector(selector);
+        selector->selector_type = operator_type;
+        selector->left = left;
+        selector->right = right;
+        *position = right_position;
+    }
+
+    return result;
+}
+// selector_parsers
+
+int order_selector(Selector *selector)
+{
+    /*
+     * Reorder operands of "and" and "or" so cheaper operand is evaluated first and can skip the other one
+     * Row range is cheapest, then prefix and substring of cell, then sets of patterns and regexes
+     *
+     * params:
+     * @selector - structure with parsed expression
+     *
+     * @return - estimated cost of evaluation of expression
+     */
+
+    switch (selector->selector_type)
+    {
+        case SELECTOR_NOT:
+            return order_selector(selector->left);
+
+        case SELECTOR_AND:
+        case SELECTOR_OR:
+        {
+            int left_cost = order_selector(selector->left);
+            int right_cost = order_selector(selector->right);
+            if (right_cost < left_cost)
+            {
+                Selector *operand = selector->left;
+                selector->left = selector->right;
+                selector->right = operand;
+            }
+
+            return left_cost + right_cost;
+        }
+
+        default:
+            // Cost of single selectors grows with their index in SELECTOR_COMS
+            return selector->selector_type + 1;
+    }
+}
+
+int get_selector(Selector *selector, int argc, char *argv[])
+{
+    /*
+     * Get line selector from arguments
+     * Only first valid selector (or expression of selectors joined by and/or/not) is loaded
+     *
+     * params:
+     * @selector - structor to save params for selector
+     * @argc - length of argument array
+     * @argv - argument array
+     *
+     * @return - NO_ERROR on success
+     *         - INPUT_ERROR if patterns of selector cant be loaded
+     */
+
+    init_selector(selector);
+    int num_of_regexes = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        int position = i;
+        int result = parse_selector_operation(selector, argc, argv, &position, &num_of_regexes, SELECTOR_OR);
+        if (result < 0)
+            return INPUT_ERROR;
+
+        if (result > 0)
+        {
+            order_selector(selector);
+            return NO_ERROR;
+        }
+    }
+
+    // If valid selector not found set selector type to -1
+    selector->selector_type = -1;
+    return NO_ERROR;
+}
+
+int get_last_selected_row(const Selector *selector)
+{
+    /*
+     * Get index of last row that can be selected by selector
+     * Only rows selector with both bounds limits selection, all other selectors can select any row
+     *
+     * params:
+     * @selector - structure with selector params
+     *
+     * @return - index of last row that can be selected
+     *         - INT_MAX if selection isnt limited
+     */
+
+    switch (selector->selector_type)
+    {
+        case SELECTOR_AND:
+        {
+            int left = get_last_selected_row(selector->left);
+            int right = get_last_selected_row(selector->right);
+            return left < right ? left : right;
+        }
+
+        case SELECTOR_OR:
+        {
+            int left = get_last_selected_row(selector->left);
+            int right = get_last_selected_row(selector->right);
+            return left > right ? left : right;
+        }
+
+        case 0:
+            // rows N M
+            if (selector->ai1 > 0 && selector->ai2 > 0)
+                return selector->ai2 - 1;
+            break;
+    }
+
+    return INT_MAX;
+}
+
+int get_first_passed_row(const Program *program, const Selector *selector)
+{
+    /*
+     * Get index of first row after which rest of input is printed unchanged
+     * In data edit mode rows after last selectable row are never changed, in pass mode no row is changed
+     * Table edit commands can change any row
+     * In column statistics and groupby modes rows after last selectable row are not read at all
+     *
+     * params:
+     * @program - compiled commands
+     * @selector - structure with selector params
+     *
+     * @return - index of first passed row
+     *         - INT_MAX if every row has to be processed
+     */
+
+    if (program->operating_mode == PASS)
+        return 0;
+
+    if (program->operating_mode == DATA_EDIT || program->operating_mode == COLUMN_STATS || program->operating_mode == GROUP_BY)
+    {
+        int last_row = get_last_selected_row(selector);
+        return last_row == INT_MAX ? INT_MAX : last_row + 1;
+    }
+
+    return INT_MAX;
+}
+
+RegexCache *get_regex_cache(Line *line, const Regex *regex)
+{
+    /*
+     * Get DFA cache of regex that belongs to line (thread), cache is created on first use
+     *
+     * params:
+     * @line - structure with line data
+     * @regex - compiled regex
+     *
+     * @return - cache of regex
+     *         - NULL if memory cant be allocated
+     */
+
+    if (regex->id >= line->num_of_regex_caches)
+    {
+        RegexCache **caches = realloc(line->regex_caches, sizeof(RegexCache *) * (size_t)(regex->id + 1));
+        if (caches == NULL)
+            return NULL;
+
+        for (int i = line->num_of_regex_caches; i <= regex->id; i++)
+            caches[i] = NULL;
+
+        line->regex_caches = caches;
+        line->num_of_regex_caches = regex->id + 1;
+    }
+
+    if (line->regex_caches[regex->id] == NULL)
+        line->regex_caches[regex->id] = create_regex_cache(regex);
+
+    return line->regex_caches[regex->id];
+}
+
+void free_line(Line *line)
+{
+    /*
+     * Release DFA caches and arena of line
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    free_arena(&line->arena);
+
+    free(line->cell_values);
+    line->cell_values = NULL;
+    line->cell_values_capacity = 0;
+
+    free(line->column_stats);
+    line->column_stats = NULL;
+    line->num_of_stats_columns = 0;
+
+    free_group_table(&line->groups);
+
+    for (int i = 0; i < line->num_of_regex_caches; i++)
+        free_regex_cache(line->regex_caches[i]);
+
+    free(line->regex_caches);
+    line->regex_caches = NULL;
+    line->num_of_regex_caches = 0;
+}
+
+int is_cell_index_valid(Line *line, int index)
+{
+    /*
+     * Check if input index is valid index of cell in row
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of cell to check
+     *
+     * @return - 1 if is valid
+     *         - 0 if not
+     */
+
+    return ((index > 0) && (index <= line->final_cols));
+}
+
+int is_line_selected(Line *line, const Selector *selector)
+{
+    /*
+     * Evaluate selector (or expression of selectors) for current line
+     * Operands of and/or are evaluated only when result isnt known from first operand
+     *
+     * params:
+     * @line - structure with line data
+     * @selector - structure with selector params
+     *
+     * @return - 1 if line is selected
+     *         - 0 if not
+     */
+
+    switch (selector->selector_type)
+    {
+        case SELECTOR_NOT:
+            return !is_line_selected(line, selector->left);
+
+        case SELECTOR_AND:
+            return is_line_selected(line, selector->left) && is_line_selected(line, selector->right);
+
+        case SELECTOR_OR:
+            return is_line_selected(line, selector->left) || is_line_selected(line, selector->right);
+
+        case 0:
+            // rows N M
+            // If both args are - then allow only last line
+            // If arg 1 is larger than 0 and arg 2 is - then check if current line index is larger or equal arg 1
+            // If both args are numbers larger than 0 then check if current line index is between or equal
+            if ((strings_equal(selector->a1, "-") && strings_equal(selector->a2, "-") && line->last_line_flag) ||
+                (selector->ai1 > 0 && strings_equal(selector->a2, "-") && line->line_index >= (selector->ai1 - 1)) ||
+                (selector->ai1 > 0 && selector->ai2 > 0 && line->line_index >= (selector->ai1 - 1) && line->line_index <= (selector->ai2 - 1)))
+            {
+                return 1;
+            }
+            break;
+
+        case 1:
+            // beginswith C STR
+            if (is_cell_index_valid(line, selector->ai1))
+            {
+                int cell_len;
+                char *cell = get_cell_span(line, selector->ai1 - 1, &cell_len);
+                if (cell != NULL)
+                {
+                    // Check if selected cell starts with string from argument
+                    if (cell_len >= selector->searcher.needle_len &&
+                        memcmp(cell, selector->str, selector->searcher.needle_len) == 0)
+                    {
+                        return 1;
+                    }
+                }
+            }
+            break;
+
+        case 2:
+        case 3:
+            // contains C STR, containsany C FILE
+            if (is_cell_index_valid(line, selector->ai1))
+            {
+                int cell_len;
+                char *cell = get_cell_span(line, selector->ai1 - 1, &cell_len);
+                if (cell != NULL)
+                {
+                    // Check if cell contains string (or some of patterns) from argument, cell is searched in place
+                    if (selector->searcher.search(cell, cell_len, &selector->searcher))
+                    {
+                        return 1;
+                    }
+                }
+            }
+            break;
+
+        case 4:
+            // matches C REGEX
+            if (is_cell_index_valid(line, selector->ai1))
+            {
+                int cell_len;
+                char *cell = get_cell_span(line, selector->ai1 - 1, &cell_len);
+                if (cell != NULL)
+                {
+                    RegexCache *cache = get_regex_cache(line, selector->regex);
+                    int result = cache == NULL ? -1 : search_regex(cache, cell, cell_len);
+                    if (result < 0)
+                        report_line_error(line, INPUT_ERROR, "\nCant allocate memory for regex on line %d\n", line->line_index + 1);
+
+                    // Check if regex matches some part of cell
+                    if (result > 0)
+                    {
+                        return 1;
+                    }
+                }
+            }
+            break;
+
+        default:
+            // If there is no valid selector then every line is selected
+            return 1;
+    }
+
+    // If selector contains some garbage or the current line is not valid by selector then line is not selected
+    return 0;
+}
+
+void validate_line_processing(Line *line, Selector *selector)
+{
+    /*
+     * Check if current line is marked by selector for processing (selected by selector)
+     *
+     * params:
+     * @line - structure with line data
+     * @selector - structure with selector params
+     */
+
+    line->process_flag = is_line_selected(line, selector);
+}
+
+int parse_cell_value(Line *line, int index, CellValue *cell)
+{
+    /*
+     * Parse type and number value of cell without caching it
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of cell
+     * @cell - output parsed value (generation isnt changed)
+     *
+     * @return - 0 on success
+     *         - -1 if cell doesnt exist or on error
+     */
+
+    char *value = get_value_of_cell(line, index);
+    if (value == NULL)
+        return -1;
+
+    if (string_to_double(value, &cell->value) == 0)
+        cell->type = CELL_NUMBER;
+    else
+        cell->type = value[0] == 0 ? CELL_EMPTY : CELL_STRING;
+
+    return 0;
+}
+
+const CellValue *get_cell_value(Line *line, int index)
+{
+    /*
+     * Get type and number value of cell, cell is parsed only on first use in current generation of line content
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of cell
+     *
+     * @return - parsed value of cell
+     *         - NULL on error
+     */
+
+    if (index < 0 || index > (line->final_cols - 1))
+        return NULL;
+
+    if (index >= line->cell_values_capacity)
+    {
+        int capacity = line->cell_values_capacity * 2 > index ? line->cell_values_capacity * 2 : index + 1;
+        CellValue *values = realloc(line->cell_values, sizeof(CellValue) * (size_t)capacity);
+        if (values == NULL)
+        {
+            report_line_memory_error(line);
+            return NULL;
+        }
+
+        memset(&values[line->cell_values_capacity], 0, sizeof(CellValue) * (size_t)(capacity - line->cell_values_capacity));
+        line->cell_values = values;
+        line->cell_values_capacity = capacity;
+    }
+
+    CellValue *cell = &line->cell_values[index];
+    if (cell->generation == line->generation)
+        return cell;
+
+    if (parse_cell_value(line, index, cell) != 0)
+        return NULL;
+
+    cell->generation = line->generation;
+    return cell;
+}
+
+void min_max_scalar_from(const double *values, int start, int length, double *min, double *max)
+{
+    /*
+     * Update minimum and maximum by values from start position, NaN values are skipped
+     *
+     * params:
+     * @values - array of values
+     * @start - position of first value
+     * @length - length of array
+     * @min - current minimum, updated in place
+     * @max - current maximum, updated in place
+     */
+
+    for (int i = start; i < length; i++)
+    {
+        if (values[i] < *min)
+            *min = values[i];
+
+        if (values[i] > *max)
+            *max = values[i];
+    }
+}
+
+#ifdef X86_SIMD
+__attribute__((target("avx2")))
+void min_max_avx2(const double *values, int length, double *min, double *max)
+{
+    /*
+     * Update minimum and maximum by values, four values are compared at once
+     * Compared value is first operand, so NaN keeps current minimum and maximum same as in scalar version
+     *
+     * params:
+     * @values - array of values
+     * @length - length of array
+     * @min - current minimum, updated in place
+     * @max - current maximum, updated in place
+     */
+
+    __m256d min_block = _mm256_set1_pd(*min);
+    __m256d max_block = _mm256_set1_pd(*max);
+
+    int i = 0;
+    for (; i + 4 <= length; i += 4)
+    {
+        __m256d block = _mm256_loadu_pd(values + i);
+        min_block = _mm256_min_pd(block, min_block);
+        max_block = _mm256_max_pd(block, max_block);
+    }
+
+    double mins[4], maxs[4];
+    _mm256_storeu_pd(mins, min_block);
+    _mm256_storeu_pd(maxs, max_block);
+
+    // Clear upper halves of registers, otherwise following SSE code is slowed by transition penalty
+    _mm256_zeroupper();
+
+    // Lanes of minimums are merged only to minimum, lane without numbers keeps initial minimum that isnt maximum
+    for (int j = 0; j < 4; j++)
+    {
+        if (mins[j] < *min)
+            *min = mins[j];
+
+        if (maxs[j] > *max)
+            *max = maxs[j];
+    }
+
+    min_max_scalar_from(values, i, length, min, max);
+}
+#endif
+
+void get_min_max(const double *values, int length, double *min, double *max)
+{
+    /*
+     * Update minimum and maximum by array of values with the fastest kernel supported by CPU
+     *
+     * params:
+     * @values - array of values
+     * @length - length of array
+     * @min - current minimum, updated in place
+     * @max - current maximum, updated in place
+     */
+
+#ifdef X86_SIMD
+    // Features of CPU are loaded when delim set is initialized
+    if (length >= 8 && __builtin_cpu_supports("avx2"))
+    {
+        min_max_avx2(values, length, min, max);
+        return;
+    }
+#endif
+
+    min_max_scalar_from(values, 0, length, min, max);
+}
+
+const RowAggregates *get_row_aggregates(Line *line, int first_cell, int last_cell)
+{
+    /*
+     * Compute all aggregates of range of cells in one pass
+     * Sum is added in order of cells so its same as when it is computed cell by cell
+     * When more aggregates can reuse the result, numbers of range are collected to continuous array and its
+     * minimum and maximum are reduced by vector kernel, single aggregate is computed directly from cells
+     * Aggregates are kept until some cell of range is edited
+     *
+     * params:
+     * @line - structure with line data
+     * @first_cell - index of first cell of range
+     * @last_cell - index of last cell of range
+     *
+     * @return - aggregates of range
+     *         - NULL on error
+     */
+
+    // Cells after last cell dont exist
+    if (last_cell > line->final_cols - 1)
+        last_cell = line->final_cols - 1;
+
+    RowAggregates *aggregates = &line->aggregates;
+    if (aggregates->generation == line->generation && aggregates->first_cell == first_cell && aggregates->last_cell == last_cell)
+        return aggregates;
+
+    int num_of_numbers = 0;
+    double *numbers = NULL;
+    if (line->vector_aggregates && (numbers = arena_alloc(&line->arena, sizeof(double) * (size_t)(last_cell - first_cell + 1))) == NULL)
+    {
+        report_line_memory_error(line);
+        return NULL;
+    }
+
+    // Initial values are same as when aggregate is computed alone
+    aggregates->generation = 0;
+    aggregates->num_of_cells = 0;
+    aggregates->num_of_nonempty = 0;
+    aggregates->sum = 0;
+    aggregates->min = DBL_MAX;
+    aggregates->max = DBL_MIN;
+
+    for (int i = first_cell; i <= last_cell; i++)
+    {
+        // Values of cells are cached only for more aggregates, single aggregate reads every cell once
+        CellValue parsed;
+        const CellValue *cell = &parsed;
+        if (numbers != NULL)
+            cell = get_cell_value(line, i);
+        else if (parse_cell_value(line, i, &parsed) != 0)
+            cell = NULL;
+
+        if (cell == NULL)
+        {
+            if (line->error_flag)
+                return NULL;
+            continue;
+        }
+
+        if (cell->type == CELL_NUMBER && numbers != NULL)
+            numbers[num_of_numbers++] = cell->value;
+        else if (cell->type == CELL_NUMBER)
+        {
+            aggregates->sum += cell->value;
+            if (cell->value < aggregates->min)
+                aggregates->min = cell->value;
+            if (cell->value > aggregates->max)
+                aggregates->max = cell->value;
+        }
+
+        aggregates->num_of_cells++;
+        if (cell->type != CELL_EMPTY)
+            aggregates->num_of_nonempty++;
+    }
+
+    if (numbers != NULL)
+    {
+        for (int i = 0; i < num_of_numbers; i++)
+            aggregates->sum += numbers[i];
+
+        get_min_max(numbers, num_of_numbers, &aggregates->min, &aggregates->max);
+    }
+
+    aggregates->first_cell = first_cell;
+    aggregates->last_cell = last_cell;
+    aggregates->generation = line->generation;
+    return aggregates;
+}
+
+int process_row_values(Line *line, int start_index, int end_index, double *ret_val, int function_flag)
+{
+    /*
+     * Process and return value of operation performed on row
+     * Supported functions: SUM - sum of selected number cells
+     *                      MIN - minimum value of selected number cells
+     *                      MAX - maximum value of selected number cells
+     *                      COUNT - count number of non empty cells
+     * params:
+     * @line - structure with line data
+     * @start_index - start index of sum interval
+     * @end_index - end index of sum interval
+     * @ret_val - return pointer for value
+     * @function_flag - flag of function used to aquire return value
+     *
+     * @return - number cells it run thru
+     *         - -1 on fail
+     */
+
+    if (is_cell_index_valid(line, start_index) && end_index > 0 &&
+        start_index <= end_index)
+    {
+        // All aggregates of range are computed together
+        const RowAggregates *aggregates = get_row_aggregates(line, start_index - 1, end_index - 1);
+        if (aggregates == NULL)
+            return -1;
+
+        double return_value = 0;
+        int cell_count = aggregates->num_of_cells;
+
+        switch (function_flag)
+        {
+            case AVG:
+            case SUM:
+                return_value = aggregates->sum;
+                break;
+
+            case MIN:
+                return_value = aggregates->min;
+                break;
+
+            case MAX:
+                return_value = aggregates->max;
+                break;
+
+            default:
+                // When we are in counting mode then we want count only not empty cells
+                cell_count = aggregates->num_of_nonempty;
+                break;
+        }
+
+        // If return value is still at initial values then no valid value was processed
+        if (return_value == DBL_MIN || return_value == DBL_MAX)
+            return -1;
+
+        // If mode is count then we want return cell count as output
+        if (function_flag == COUNT)
+            (*ret_val) = (double)cell_count;
+        else
+            (*ret_val) = return_value;
+
+        return cell_count;
+    }
+
+    return -1;
+}
+
+void add_to_column_stats(ColumnStats *stats, double value)
+{
+    /*
+     * Add number to statistics of column
+     *
+     * params:
+     * @stats - statistics of column
+     * @value - number from cell of column
+     */
+
+    if (stats->count == 0 || value < stats->min)
+        stats->min = value;
+    if (stats->count == 0 || value > stats->max)
+        stats->max = value;
+
+    // Lost low part of smaller operand is kept in compensation
+    // Infinite sum (from inf cell or overflow) isnt compensated, difference with it would be NaN
+    double sum = stats->sum + value;
+    double abs_sum = stats->sum < 0 ? -stats->sum : stats->sum;
+    double abs_value = value < 0 ? -value : value;
+    if (sum - sum != 0)
+        stats->compensation = 0;
+    else if (abs_sum >= abs_value)
+        stats->compensation += (stats->sum - sum) + value;
+    else
+        stats->compensation += (value - sum) + stats->sum;
+    stats->sum = sum;
+
+    stats->count++;
+    double delta = value - stats->mean;
+    stats->mean += delta / stats->count;
+    stats->m2 += delta * (value - stats->mean);
+}
+
+void add_row_to_column_stats(Line *line)
+{
+    /*
+     * Add number cells of row to statistics of their columns
+     * Number of columns is taken from reference number of cols, NaN values are skipped
+     *
+     * params:
+     * @line - structure with line data
+     */
+
+    if (line->num_of_stats_columns == 0 && line->num_of_cols > 0)
+    {
+        ColumnStats *stats = realloc(line->column_stats, sizeof(ColumnStats) * (size_t)line->num_of_cols);
+        if (stats == NULL)
+        {
+            report_line_memory_error(line);
+            return;
+        }
+
+        memset(stats, 0, sizeof(ColumnStats) * (size_t)line->num_of_cols);
+        line->column_stats = stats;
+        line->num_of_stats_columns = line->num_of_cols;
+    }
+
+    for (int i = 0; i < line->num_of_stats_columns; i++)
+    {
+        const CellValue *cell = get_cell_value(line, i);
+        if (cell == NULL)
+        {
+            if (line->error_flag)
+                return;
+            continue;
+        }
+
+        if (cell->type == CELL_NUMBER && cell->value == cell->value)
+            add_to_column_stats(&line->column_stats[i], cell->value);
+    }
+}
+
+void write_column_stats(OutputBuffer *output, const Line *line_holder)
+{
+    /*
+     * Write rows with statistics of columns, first cell of each row is name of statistic
+     * Value is empty when column doesnt have enough numbers for it (variance is sample variance)
+     *
+     * params:
+     * @output - structure with output buffer data
+     * @line_holder - structure with line data after last line
+     */
+
+    const char *names[] = {"count", "sum", "min", "max", "mean", "var"};
+    int num_of_names = (int)(sizeof(names) / sizeof(names[0]));
+    char buffer[MAX_NUMBER_LEN + 1];
+    ColumnStats empty_stats;
+    memset(&empty_stats, 0, sizeof(empty_stats));
+
+    for (int row = 0; row < num_of_names; row++)
+    {
+        write_to_output(output, names[row], strlen(names[row]));
+
+        for (int i = 0; i < line_holder->num_of_cols; i++)
+        {
+            const ColumnStats *stats = i < line_holder->num_of_stats_columns ? &line_holder->column_stats[i] : &empty_stats;
+            write_char_to_output(output, line_holder->delim);
+
+            double value = 0;
+            int has_value = stats->count > 0;
+            switch (row)
+            {
+                case 0:
+                    value = (double)stats->count;
+                    has_value = 1;
+                    break;
+
+                case 1:
+                    value = stats->sum + stats->compensation;
+                    has_value = 1;
+                    break;
+
+                case 2:
+                    value = stats->min;
+                    break;
+
+                case 3:
+                    value = stats->max;
+                    break;
+
+                case 4:
+                    value = (stats->sum + stats->compensation) / stats->count;
+                    break;
+
+                default:
+                    has_value = stats->count > 1;
+                    value = has_value ? stats->m2 / (stats->count - 1) : 0;
+                    break;
+            }
+
+            if (has_value)
+                write_to_output(output, buffer, (size_t)number_to_string(value, buffer));
+        }
+
+        write_char_to_output(output, '\n');
+    }
+}
+
+void add_to_group_value(GroupValue *value, const CellValue *cell)
+{
+    /*
+     * Add cell of row to aggregated value of its column in group, NaN values are not numbers of group
+     *
+     * params:
+     * @value - value of group
+     * @cell - parsed value of cell
+     */
+
+    if (cell->type != CELL_EMPTY)
+        value->nonempty++;
+
+    if (cell->type != CELL_NUMBER || cell->value != cell->value)
+        return;
+
+    if (value->count == 0 || cell->value < value->min)
+        value->min = cell->value;
+    if (value->count == 0 || cell->value > value->max)
+        value->max = cell->value;
+
+    value->sum += cell->value;
+    value->count++;
+}
+
+void add_row_to_groups(Line *line, const Program *program)
+{
+    /*
+     * Add row to group of its key and aggregate its cells, rows without key column are in group of empty key
+     * Groups are spilled to partition files when table of groups exceeds memory limit
+     *
+     * params:
+     * @line - structure with line data
+     * @program - compiled aggregates of groupby
+     */
+
+    GroupTable *table = &line->groups;
+    if (table->memory_limit == 0)
+        init_group_table(table, program->num_of_commands, program->group_memory_limit, 0);
+
+    // Key is hashed and compared in line, only key of new group is copied
+    int key_len = 0;
+    const char *key = get_cell_span(line, program->group_column - 1, &key_len);
+    if (key == NULL)
+    {
+        key = "";
+        key_len = 0;
+    }
+
+    Group *group = get_group(table, key, key_len, hash_bytes(key, key_len));
+    if (group == NULL)
+    {
+        report_line_error(line, INPUT_ERROR, "\nCant allocate memory for group of line %d\n", line->line_index + 1);
+        return;
+    }
+
+    for (int i = 0; i < program->num_of_commands; i++)
+    {
+        const CellValue *cell = get_cell_value(line, program->commands[i].args[0] - 1);
+        if (cell == NULL)
+        {
+            if (line->error_flag)
+                return;
+            continue;
+        }
+
+        add_to_group_value(&group->values[i], cell);
+    }
+
+    if (is_group_table_full(table) && spill_groups(table) != NO_ERROR)
+        report_line_error(line, OUTPUT_ERROR, "\nCant write temporary file of groups\n");
+}
+
+void write_group(OutputBuffer *output, const Group *group, const Program *program, char delim)
+{
+    /*
+     * Write row of group, first cell is key and other cells are aggregates in order of commands
+     * Average, minimum and maximum are empty when group doesnt have numbers in their column
+     *
+     * params:
+     * @output - structure with output buffer data
+     * @group - group to write
+     * @program - compiled aggregates of groupby
+     * @delim - delim of cells
+     */
+
+    char buffer[MAX_NUMBER_LEN + 1];
+    write_to_output(output, group->key, (size_t)group->key_len);
+
+    for (int i = 0; i < program->num_of_commands; i++)
+    {
+        const GroupValue *value = &group->values[i];
+        write_char_to_output(output, delim);
+
+        double number;
+        int has_value = value->count > 0;
+        switch (program->commands[i].com_index)
+        {
+            case SUM:
+                number = value->sum;
+                has_value = 1;
+                break;
+
+            case MIN:
+                number = value->min;
+                break;
+
+            case MAX:
+                number = value->max;
+                break;
+
+            case AVG:
+                number = has_value ? value->sum / value->count : 0;
+                break;
+
+            default:
+                number = (double)value->nonempty;
+                has_value = 1;
+                break;
+        }
+
+        if (has_value)
+            write_to_output(output, buffer, (size_t)number_to_string(number, buffer));
+    }
+
+    write_char_to_output(output, '\n');
+}
+
+int write_groups(OutputBuffer *output, GroupTable *table, const Program *program, char delim)
+{
+    /*
+     * Write one row for every group of table
+     * Groups are written in order of their first rows, groups of spilled table are merged and written
+     * partition after partition
+     *
+     * params:
+     * @output - structure with output buffer data
+     * @table - structure with table data
+     * @program - compiled aggregates of groupby
+     * @delim - delim of cells
+     *
+     * @return - NO_ERROR on success
+     *         - error code when spilled groups cant be merged
+     */
+
+    if (!table->spilled)
+    {
+        for (int i = 0; i < table->num_of_groups; i++)
+            write_group(output, &table->groups[i], program, delim);
+
+        return NO_ERROR;
+    }
+
+    // Groups left in memory are spilled too, so all parts of group are in the same partition
+    if (spill_groups(table) != NO_ERROR)
+    {
+        fprintf(stderr, "Cant write temporary file of groups\n");
+        return OUTPUT_ERROR;
+    }
+
+    for (int i = 0; i < NUM_OF_SPILL_PARTITIONS; i++)
+    {
+        if (table->partitions[i] == NULL)
+            continue;
+
+        GroupTable partition_table;
+        init_group_table(&partition_table, table->num_of_values, table->memory_limit, table->depth + 1);
+
+        int error_flag = load_group_partition(&partition_table, table->partitions[i]);
+        if (error_flag == NO_ERROR)
+            error_flag = write_groups(output, &partition_table, program, delim);
+
+        free_group_table(&partition_table);
+        fclose(table->partitions[i]);
+        table->partitions[i] = NULL;
+
+        if (error_flag != NO_ERROR)
+            return error_flag;
+    }
+
+    return NO_ERROR;
+}
+
+void create_emty_row_at(Line *line, int index)
+{
+    /*
+     * Create empty row before index row in line string
+     * Unedited line is processed again after the empty row is printed
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of row where to create empty line
+     */
+
+    if ((index > 0) && (index == (line->line_index + 1)))
+    {
+        // Mark unedited line for next processing
+        line->row_inserted = 1;
+        // Create empty line in line object
+        generate_empty_row(line);
+    }
+}
+
+void delete_rows_in_interval(Line *line, int start_index, int end_index)
+{
+    /*
+     * Delete row if index of line is in passed interval
+     * Start and end indexes included
+     *
+     * params:
+     * @line - structure with line data
+     * @start_index - start index value
+     * @end_index - end index value
+     */
+
+    if (start_index > 0 && end_index > 0 &&
+        start_index <= end_index)
+    {
+        // If line index is in interval delete it
+        if (start_index <= (line->line_index + 1) && end_index >= (line->line_index + 1))
+        {
+            delete_line_content(line);
+        }
+    }
+}
+
+void insert_empty_cell_at(Line *line, int index)
+{
+    /*
+     * Insert empty cell before cell of passed index if that cell exist
+     *
+     * params:
+     * @line - structure with line data
+     * @index - input index of cell
+     */
+
+    // If cell index is valid insert empty cell before index
+    if (is_cell_index_valid(line, index))
+    {
+        insert_empty_cell(line, index - 1);
+    }
+}
+
+int remove_cells(Line *line, int start_index, int end_index)
+{
+    /*
+     * Remove range of whole cells with one edit of line
+     * Delim after the range is removed too, if range ends with last cell then delim in front of range is removed
+     *
+     * params:
+     * @line - structure with line data
+     * @start_index - index of first removed cell
+     * @end_index - index of last removed cell (must be valid cell)
+     *
+     * @return - 0 on success
+     *         - -1 on error
+     */
+
+    int start_position, end_position;
+
+    if (end_index < (line->final_cols - 1))
+    {
+        // Remove cells with delim behind them
+        start_position = get_start_of_substring(line, start_index);
+        end_position = get_start_of_substring(line, end_index + 1) - 1;
+    }
+    else if (start_index > 0)
+    {
+        // Remove rest of line with delim in front of first cell
+        start_position = get_start_of_substring(line, start_index) - 1;
+        end_position = line->line_len - 1;
+    }
+    else
+    {
+        // All cells are removed
+        start_position = 0;
+        end_position = line->line_len - 1;
+    }
+
+    if (end_position >= start_position && remove_substring(line, start_position, end_position) != 0)
+        return -1;
+
+    line->final_cols -= end_index - start_index + 1;
+    invalidate_cell_values(line);
+    return 0;
+}
+
+void delete_cells_in_interval(Line *line, int start_index, int end_index)
+{
+    /*
+     * Delete cells with indexes in input interval
+     * Whole interval is removed by one edit of line, interval is limited by last cell
+     *
+     * params:
+     * @line - structure with line data
+     * @start_index - start index value
+     * @end_index - end index value
+     */
+
+    if (is_cell_index_valid(line, start_index) && end_index > 0 && start_index <= end_index && !is_line_empty(line))
+    {
+        if (end_index > line->final_cols)
+            end_index = line->final_cols;
+
+        // Range can be computed from delims only if line has expected number of cells
+        if (get_number_of_cells(line) != line->final_cols)
+        {
+            for (int j = start_index; j <= end_index; j++)
+            {
+                // If line is not empty try to remove cell
+                if (!is_line_empty(line))
+                    remove_cell(line, start_index - 1);
+            }
+            return;
+        }
+
+        remove_cells(line, start_index - 1, end_index - 1);
+    }
+}
+
+int set_value_in_cell(Line *line, int index, char *value)
+{
+    /*
+     * Clear content of cell and insert new value
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of cell set value
+     * @value - string to set
+     *
+     * @return - 0 on sucess
+     *         - -1 on error
+     */
+
+    if (is_cell_index_valid(line, index))
+    {
+        // Clear value from cell
+        clear_cell(line, index - 1);
+        // Set new value to cell
+        return insert_to_cell(line, index - 1, value);
+    }
+
+    return -1;
+}
+
+int set_number_in_cell(Line *line, int index, double value)
+{
+    /*
+     * Clear content of cell and insert formated number value to edit buffer of line
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of cell set value
+     * @value - number to set, formated as int when it has no decimal part
+     *
+     * @return - 0 on sucess
+     *         - -1 on error
+     */
+
+    if (is_cell_index_valid(line, index))
+    {
+        clear_cell(line, index - 1);
+
+        int pos = get_start_of_substring(line, index - 1);
+        if (pos < 0)
+            return -1;
+
+        // Number is formated first, so gap is grown only when it has no space for the number itself
+        char buffer[MAX_NUMBER_LEN + 1];
+        int length = number_to_string(value, buffer);
+        if (make_line_editable(line) != 0 || reserve_line_space(line, length) != 0)
+            return -1;
+
+        move_gap(line, pos);
+        memcpy(&line->edit_buffer[line->gap_start], buffer, (size_t)length);
+        invalidate_cell_value(line, index - 1);
+        commit_gap_insert(line, length);
+        return 0;
+    }
+
+    return -1;
+}
+
+void cell_value_editing(Line *line, int index, int processing_flag)
+{
+    /*
+     * Function to process value of single cell
+     * Supported functions: UPPER - to uppercase
+     *                      LOWER - to lowercase
+     *                      ROUND - round value if its number
+     *                      INT - conver value to int if its number
+     *
+     * params:
+     * @line - structure with line data
+     * @index - index of cell
+     * @processing_flag - flag of function
+     */
+
+    if (is_cell_index_valid(line, index))
+    {
+        // Load value from cell
+        char *cell_buff = get_value_of_cell(line, index - 1);
+        if (cell_buff != NULL)
+        {
+            double cell_double;
+
+            // Check if the cell is not number (int should be double too) and convert it
+            if (string_to_double(cell_buff, &cell_double) != 0)
+            {
+                // Upper/lower conversion of string
+                if (processing_flag == UPPER)
+                    string_conversion(cell_buff, UPPER);
+                else if (processing_flag == LOWER)
+                    string_conversion(cell_buff, LOWER);
+            }
+            else if (processing_flag == ROUND || processing_flag == INT)
+            {
+                // Round/int double processing
+                if (processing_flag == ROUND)
+                    set_number_in_cell(line, index, round_double(cell_double));
+                else
+                    set_number_in_cell(line, index, (int)cell_double);
+                return;
+            }
+
+            // Set processed value to cell
+            set_value_in_cell(line, index, cell_buff);
+        }
+    }
+}
+
+void copy_cell_value_to(Line *line, int source_index, int target_index)
+{
+    /*
+     * Copy value from one cell to another
+     * Source and target index cant be same
+     *
+     * params:
+     * @line - structure with line data
+     * @source_index - index of source cell
+     * @target_index - index of destination cell
+     */
+
+    if (is_cell_index_valid(line, source_index) && is_cell_index_valid(line, target_index) &&
+        source_index != target_index)
+    {
+        // Load value of source cell
+        char *cell_buff = get_value_of_cell(line, source_index - 1);
+        if (cell_buff != NULL)
+            // Set value to target cell
+            set_value_in_cell(line, target_index, cell_buff);
+    }
+}
+
+void swap_cell_values(Line *line, int index1, int index2)
+{
+    /*
+     * Swap values of cells
+     * Index1 and index2 can be same
+     *
+     * params:
+     * @line - structure with line data
+     * @index1 - index of first cell
+     * @index2 - index of second cell
+     */
+
+    if (is_cell_index_valid(line, index1) && is_cell_index_valid(line, index2) &&
+        index1 != index2)
+    {
+        // Load both cells
+        char *cell_buff1 = get_value_of_cell(line, index1 - 1);
+        char *cell_buff2 = cell_buff1 == NULL ? NULL : get_value_of_cell(line, index2 - 1);
+        if (cell_buff2 != NULL)
+        {
+            // Set new values to cells
+            set_value_in_cell(line, index1, cell_buff2);
+            set_value_in_cell(line, index2, cell_buff1);
+        }
+    }
+}
+
+void move_cell_to(Line *line, int source_index, int target_index)
+{
+    /*
+     * Move cell of source index before cell of target index
+     * Source and target index cant be same
+     *
+     * params:
+     * @line - structure with line data
+     * @source_index - index of cell to move
+     * @target_index - index of cell to move to
      */
 
     if (is_cell_index_valid(line, source_index) && is_cell_index_valid(line, target_index) &&
         source_index != target_index)
     {
-        char cell_buff[MAX_CELL_LEN + 1];
+        char *cell_buff = get_value_of_cell(line, source_index - 1);
+        if (cell_buff != NULL)
+        {
+            if (source_index < target_index)
+            {
+                // Insert empty cell before target cell
+                if (insert_empty_cell(line, target_index - 1) != 0)
+                    return;
+
+                // Remove original cell
+                remove_cell(line, source_index - 1);
+                // Insert value to before created empty cell
+                insert_to_cell(line, target_index - 2, cell_buff);
+            }
+            else
+            {
+                // Insert empty cell before target cell
+                if (insert_empty_cell(line, target_index - 1) != 0)
+                    return;
+
+                // Remove original cell
+                remove_cell(line, source_index);
+                // Insert value to before created empty cell
+                insert_to_cell(line, target_index - 1, cell_buff);
+            }
+        }
+    }
+}
+
+void row_values_processing(Line *line, int output_index, int start_index, int end_index, int function_flag)
+{
+    /*
+     * Process cells with index in inputed interval by function selected by flag
+     * Supported functions: SUM - sum of selected number cells
+     *                      AVG - count average value of selected number cells
+     *                      MIN - minimum value of selected number cells
+     *                      MAX - maximum value of selected number cells
+     *                      COUNT - count number of non empty cells
+     *
+     * params:
+     * @line - structure with line data
+     * @output_index - index of cell where to output processed value
+     * @start_index - start index of processing interval
+     * @end_index - end index of processing interval
+     * @function_flag - flag of function to use
+     */
+
+    if (is_cell_index_valid(line, output_index) &&
+        (output_index < start_index || output_index > end_index))
+    {
+        double setval;
+        int processed_cells;
+
+        if ((processed_cells = process_row_values(line, start_index, end_index, &setval, function_flag)) == -1)
+            return;
+
+        if (function_flag == AVG)
+            setval /= processed_cells;
+
+        // Value without decimal part is formated as int
+        set_number_in_cell(line, output_index, setval);
+    }
+}
+
+void row_sequence_gen(Line *line, int start_index, int end_index, int start_value)
+{
+    /*
+     * Create sequence of number starting from start value in cells with index from inputed interval
+     *
+     * params:
+     * @line - structure with line data
+     * @start_index - start index of processing interval
+     * @end_index - end index of processing interval
+     * @start_value - start value of number sequence
+     */
+
+    if (is_cell_index_valid(line, start_index) && end_index > 0)
+    {
+        for (int i = start_index; i <= end_index; i++, start_value++)
+        {
+            if (set_number_in_cell(line, i, start_value) != 0)
+                return;
+        }
+    }
+}
+
+void table_edit(Line *line, const Command *command)
+{
+    /*
+     * Function to apply table edit command to line
+     *
+     * params:
+     * @line - structure with line data
+     * @command - compiled command to use
+     */
+
+    if (line->error_flag)
+        return;
+
+    switch (command->com_index)
+    {
+        // TODO: Make row indexing consistent after removing/adding lines
+        case 0:
+            // irow R
+            create_emty_row_at(line, command->args[0]);
+            break;
+
+        case 2:
+            // drow R
+            delete_rows_in_interval(line, command->args[0], command->args[0]);
+            break;
+
+        case 3:
+            // drows N M
+            delete_rows_in_interval(line, command->args[0], command->args[1]);
+            break;
+
+        case 4:
+            // icol C
+            insert_empty_cell_at(line, command->args[0]);
+            break;
+
+        case 5:
+            // acol
+            append_empty_cell(line);
+            break;
+
+        case 6:
+            // dcol C
+            delete_cells_in_interval(line, command->args[0], command->args[0]);
+            break;
+
+        case 7:
+            // dcols N M
+            delete_cells_in_interval(line, command->args[0], command->args[1]);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void data_edit(Line *line, const Command *command)
+{
+    /*
+     * Function to apply data edit command to line
+     *
+     * params:
+     * @line - structure with line data
+     * @command - compiled command to use
+     */
+
+    if (line->error_flag)
+        return;
+
+    // Edit line data only when its flagged as line to edit
+    if (line->process_flag)
+    {
+        switch (command->com_index)
+        {
+            case 0:
+                // cset C STR
+                set_value_in_cell(line, command->args[0], command->str);
+                break;
+
+            case 1:
+                // tolower C
+                cell_value_editing(line, command->args[0], LOWER);
+                break;
+
+            case 2:
+                // toupper C
+                cell_value_editing(line, command->args[0], UPPER);
+                break;
+
+            case 3:
+                // round C
+                cell_value_editing(line, command->args[0], ROUND);
+                break;
+
+            case 4:
+                // int C
+                cell_value_editing(line, command->args[0], INT);
+                break;
+
+            case 5:
+                // copy N M
+                copy_cell_value_to(line, command->args[0], command->args[1]);
+                break;
+
+            case 6:
+                // swap N M
+                swap_cell_values(line, command->args[0], command->args[1]);
+                break;
+
+            case 7:
+                // move N M
+                move_cell_to(line, command->args[0], command->args[1]);
+                break;
+
+            case 8:
+                // csum C N M
+                row_values_processing(line, command->args[0], command->args[1], command->args[2], SUM);
+                break;
+
+            case 9:
+                // cavg C N M
+                row_values_processing(line, command->args[0], command->args[1], command->args[2], AVG);
+                break;
+
+            case 10:
+                // cmin C N M
+                row_values_processing(line, command->args[0], command->args[1], command->args[2], MIN);
+                break;
+
+            case 11:
+                // cmax C N M
+                row_values_processing(line, command->args[0], command->args[1], command->args[2], MAX);
+                break;
+
+            case 12:
+                // ccount C N M
+                row_values_processing(line, command->args[0], command->args[1], command->args[2], COUNT);
+                break;
+
+            case 13:
+                // cseq N M B
+                row_sequence_gen(line, command->args[0], command->args[1], command->args[2]);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+int merge_cell_deletions(Command *previous, const Command *command)
+{
+    /*
+     * Join dcol/dcols command to previous dcol/dcols command when its range starts in or right behind deleted range
+     * Range of command is in indexes after previous deletion, so cells behind deleted range are shifted by its length
+     *
+     * params:
+     * @previous - previous compiled command, it is changed to dcols of joined range
+     * @command - compiled command that follows it
+     *
+     * @return - 1 if command was joined to previous command
+     *         - 0 if not
+     */
+
+    if ((previous->com_index != 6 && previous->com_index != 7) || (command->com_index != 6 && command->com_index != 7))
+        return 0;
+
+    int start = previous->args[0];
+    int end = previous->com_index == 6 ? start : previous->args[1];
+    int next_start = command->args[0];
+    int next_end = command->com_index == 6 ? next_start : command->args[1];
+
+    // Invalid ranges are left to commands, they dont delete anything
+    if (start < 1 || start > end || next_start < 1 || next_start > next_end)
+        return 0;
+
+    // Ranges must overlap or touch in indexes after previous deletion
+    if (next_start > start || next_end < start - 1)
+        return 0;
+
+    int length = end - start + 1;
+    previous->com_index = 7;
+    previous->args[0] = next_start;
+    previous->args[1] = next_end >= start ? (next_end > INT_MAX - length ? INT_MAX : next_end + length) : end;
+    return 1;
+}
+
+int compile_group_by(Program *program, int argc, char *argv[], int position)
+{
+    /*
+     * Compile groupby K and aggregates that follow it (sum C, min C, max C, avg C, count C)
+     * Aggregates are stored as commands with index of function and column
+     *
+     * params:
+     * @program - structure for compiled commands
+     * @argc - length of argument array
+     * @argv - argument array
+     * @position - index of groupby in argument array
+     *
+     * @return - NO_ERROR on success
+     *         - INPUT_ERROR if arguments are invalid or groupby is used with editing commands or --colstats
+     */
+
+    if (program->num_of_commands > 0 || program->num_of_appended_rows > 0 || program->operating_mode == COLUMN_STATS)
+    {
+        fprintf(stderr, "Editing commands and --colstats cant be used with groupby\n");
+        return INPUT_ERROR;
+    }
+
+    if (position + 1 >= argc || !is_string_int(argv[position + 1]) ||
+        string_to_int(argv[position + 1], &program->group_column) != 0 || program->group_column < 1)
+    {
+        fprintf(stderr, "Invalid key column of groupby\n");
+        return INPUT_ERROR;
+    }
+
+    for (int i = position + 2; i < argc; i += 2)
+    {
+        int com_index = get_group_com_index(argv[i]);
+        if (com_index < 0)
+            break;
+
+        Command *command = &program->commands[program->num_of_commands];
+        command->com_index = com_index;
+        command->str = NULL;
+        command->args[1] = command->args[2] = 0;
+
+        if (i + 1 >= argc || !is_string_int(argv[i + 1]) || string_to_int(argv[i + 1], &command->args[0]) != 0 || command->args[0] < 1)
+        {
+            fprintf(stderr, "Invalid column of %s\n", argv[i]);
+            return INPUT_ERROR;
+        }
+
+        program->num_of_commands++;
+    }
+
+    // Memory limit is in megabytes
+    int memory_limit = DEFAULT_GROUP_MEMORY_MB;
+    char *memory_arg = get_opt(argc, argv, "--group-memory");
+    if (memory_arg != NULL && (!is_string_int(memory_arg) || string_to_int(memory_arg, &memory_limit) != 0 || memory_limit < 1))
+    {
+        fprintf(stderr, "Invalid group memory %s\n", memory_arg);
+        return INPUT_ERROR;
+    }
+
+    program->group_memory_limit = (size_t)memory_limit << 20;
+    program->operating_mode = GROUP_BY;
+    return NO_ERROR;
+}
+
+int compile_program(Program *program, int argc, char *argv[])
+{
+    /*
+     * Translate arguments to list of commands for current operating mode
+     * Commands are looked up and their numeric arguments are converted only once for whole input
+     *
+     * params:
+     * @program - structure for compiled commands
+     * @argc - length of argument array
+     * @argv - argument array
+     *
+     * @return - NO_ERROR on success
+     *         - INPUT_ERROR if memory for commands cant be allocated, commands are used with --colstats or groupby
+     *           is invalid
+     */
+
+    program->operating_mode = get_op_mode(argv, argc);
+    program->num_of_commands = 0;
+    program->num_of_appended_rows = 0;
+    program->last_inserted_row = 0;
+    program->first_passed_row = INT_MAX;
+    program->num_of_aggregates = 0;
+    program->group_column = 0;
+    program->group_memory_limit = 0;
+
+    program->commands = malloc(sizeof(Command) * (size_t)argc);
+    if (program->commands == NULL)
+    {
+        fprintf(stderr, "Cant allocate memory for commands\n");
+        return INPUT_ERROR;
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        int com_index = -1;
+
+        // Command from other operating modes will be ignored
+        if (program->operating_mode == TABLE_EDIT)
+            com_index = get_table_com_index(argv[i]);
+        else if (program->operating_mode == DATA_EDIT)
+            com_index = get_data_com_index(argv[i]);
+
+        if (com_index < 0)
+            continue;
+
+        // arow is processed after last line
+        if (program->operating_mode == TABLE_EDIT && com_index == 1)
+        {
+            program->num_of_appended_rows++;
+            continue;
+        }
+
+        Command *command = &program->commands[program->num_of_commands];
+        command->com_index = com_index;
+        command->str = NULL;
+        for (int j = 0; j < 3; j++)
+            command->args[j] = argument_to_int(argv, argc, i + j + 1);
+
+        if (program->operating_mode == DATA_EDIT && com_index == 0)
+        {
+            // cset needs string argument
+            if ((i + 2) >= argc)
+                continue;
+
+            command->str = argv[i + 2];
+        }
+
+        if (program->operating_mode == TABLE_EDIT && com_index == 0 && command->args[0] > program->last_inserted_row)
+            program->last_inserted_row = command->args[0];
+
+        if (program->operating_mode == DATA_EDIT && com_index >= 8 && com_index <= 12)
+            program->num_of_aggregates++;
+
+        // Following deletions of cells are joined to one range, so row is edited only once
+        if (program->operating_mode == TABLE_EDIT && program->num_of_commands > 0 &&
+            merge_cell_deletions(&program->commands[program->num_of_commands - 1], command))
+            continue;
+
+        program->num_of_commands++;
+    }
+
+    // Selected rows are only added to statistics of columns, so they cant be edited
+    if (find_argument(argc, argv, "--colstats") >= 0)
+    {
+        if (program->num_of_commands > 0 || program->num_of_appended_rows > 0)
+        {
+            fprintf(stderr, "Editing commands cant be used with --colstats\n");
+            return INPUT_ERROR;
+        }
+
+        program->operating_mode = COLUMN_STATS;
+    }
+
+    // Selected rows are only aggregated to groups, so they cant be edited too
+    int group_by = find_argument(argc, argv, GROUP_BY_COM);
+    if (group_by >= 0)
+        return compile_group_by(program, argc, argv, group_by);
+
+    return NO_ERROR;
+}
+
+void free_program(Program *program)
+{
+    /*
+     * Release memory of compiled commands
+     *
+     * params:
+     * @program - structure with compiled commands
+     */
+
+    free(program->commands);
+    program->commands = NULL;
+    program->num_of_commands = 0;
+}
+
+int is_row_inserted_at(const Program *program, int index)
+{
+    /*
+     * Check if program contains irow command for row index
+     *
+     * params:
+     * @program - compiled commands
+     * @index - index of row (starting from 1)
+     *
+     * @return - 1 if row is inserted at index
+     *         - 0 if not
+     */
+
+    if (program->operating_mode != TABLE_EDIT)
+        return 0;
+
+    for (int i = 0; i < program->num_of_commands; i++)
+    {
+        if (program->commands[i].com_index == 0 && program->commands[i].args[0] == index)
+            return 1;
+    }
+
+    return 0;
+}
+
+int advance_line_index(const Program *program, int line_index, int num_of_lines)
+{
+    /*
+     * Compute line index after processing of input lines
+     * Every line increments index by one, irow adds one more for each empty row printed before the line
+     *
+     * params:
+     * @program - compiled commands
+     * @line_index - line index before first line
+     * @num_of_lines - number of processed input lines
+     *
+     * @return - line index after last line
+     */
+
+    // Lines behind last inserted row are only counted
+    while (num_of_lines > 0 && line_index < program->last_inserted_row)
+    {
+        // Inserted row is printed before the line and line is processed again with next index
+        while (is_row_inserted_at(program, line_index + 1))
+            line_index++;
+
+        line_index++;
+        num_of_lines--;
+    }
+
+    return line_index + num_of_lines;
+}
+
+void process_line(Line *line, Selector *selector, const Program *program, int last_line_executed)
+{
+    /*
+    Process loaded line data
+
+    params:
+    @line - structure with line data
+    @selector - structure with selector params
+    @program - compiled commands
+    @last_line_executed - flag to indicate that last line is executed
+    */
+
+    int operating_mode = program->operating_mode;
+
+    // Initialize/clear line states
+    line->deleted = 0;
+    line->final_cols = line->num_of_cols;
+    line->vector_aggregates = program->num_of_aggregates > 1;
+
+    // Selected rows are added to statistics of columns or to their groups, rows are not printed
+    if (operating_mode == COLUMN_STATS || operating_mode == GROUP_BY)
+    {
+        validate_line_processing(line, selector);
+        if (line->process_flag && operating_mode == COLUMN_STATS)
+            add_row_to_column_stats(line);
+        else if (line->process_flag)
+            add_row_to_groups(line, program);
+
+        line->line_index++;
+        return;
+    }
+
+    // Rows after last selectable row are printed unchanged without evaluating selector
+    if (line->line_index >= program->first_passed_row)
+    {
+        line->process_flag = operating_mode == PASS;
+        pass_line(line);
+        return;
+    }
+
+    // Check if data in line should be processed
+    validate_line_processing(line, selector);
+
+    // Lines that wont be changed are printed without parsing of cells
+    if (operating_mode == PASS || (operating_mode == DATA_EDIT && !line->process_flag))
+    {
+        pass_line(line);
+        return;
+    }
+
+    // Sanity of line
+    if (!check_line_sanity(line))
+        return;
+
+    line->row_inserted = 0;
+
+    for (int i = 0; i < program->num_of_commands; i++)
+    {
+        // Perform actions based on operating mode
+        switch (operating_mode)
+        {
+            case TABLE_EDIT:
+                table_edit(line, &program->commands[i]);
+                break;
+
+            case DATA_EDIT:
+                data_edit(line, &program->commands[i]);
+                break;
+
+            default:
+                break;
+        }
+
+        // If there was some memory error return to main
+        if (line->error_flag)
+            return;
+    }
+
+    // Print line from line structure
+    print_line(line);
+
+    // Check if there was inserted row before current line
+    if (line->row_inserted)
+    {
+        // If there was inserted row load unedited line to line structure and recursively call this function to process that line
+        load_line_string(line, line->unedited_line_string, line->unedited_line_len);
+        process_line(line, selector, program, 0);
+    }
+
+    // There will be processed appending of new rows
+    if (line->last_line_flag && !last_line_executed)
+    {
+        if (operating_mode == TABLE_EDIT)
+        {
+            for (int i = 0; i < program->num_of_appended_rows; i++)
+            {
+                // arow
+                generate_empty_row(line);
+                print_line(line);
+            }
+        }
+    }
+}
+
+int open_input(InputReader *reader, const char *file_path)
+{
+    /*
+     * Prepare input reader
+     * If file path is passed then the file is memory mapped, otherwise lines are read from stdin
+     *
+     * params:
+     * @reader - structure with reader data
+     * @file_path - path to input file or NULL for stdin
+     *
+     * @return - NO_ERROR on success
+     *         - INPUT_ERROR if file cant be mapped
+     */
+
+    reader->file_input = file_path != NULL;
+    reader->data = NULL;
+    reader->size = 0;
+    reader->position = 0;
+    reader->range_end = 0;
+    reader->buffers[0] = reader->buffers[1] = NULL;
+    reader->buffer_sizes[0] = reader->buffer_sizes[1] = 0;
+    reader->current_buffer = 0;
+    reader->carry = NULL;
+    reader->carry_length = 0;
+    reader->carry_capacity = 0;
+    reader->end_of_input = 0;
+
+    if (file_path == NULL)
+        return NO_ERROR;
+
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Cant open input file %s\n", file_path);
+        return INPUT_ERROR;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0)
+    {
+        fprintf(stderr, "Cant open input file %s\n", file_path);
+        close(fd);
+        return INPUT_ERROR;
+    }
+
+    reader->size = (size_t)file_stat.st_size;
+    reader->range_end = reader->size;
+
+    // Empty file cant be mapped, it will be handled as empty input
+    if (reader->size > 0)
+    {
+        // Mapping is read only, lines with other delims are normalized in copies (pages stay backed by the file)
+        void *data = mmap(NULL, reader->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            fprintf(stderr, "Cant map input file %s\n", file_path);
+            close(fd);
+            return INPUT_ERROR;
+        }
+
+        posix_madvise(data, reader->size, POSIX_MADV_SEQUENTIAL);
+        reader->data = data;
+    }
+
+    close(fd);
+    return NO_ERROR;
+}
+
+int read_input_line(InputReader *reader, char **line, int *length)
+{
+    /*
+     * Load next line from input without new line characters
+     * Lines from mapped file are not copied, line from stdin stays valid until next line is read
+     *
+     * params:
+     * @reader - structure with reader data
+     * @line - output pointer to start of line (line from mapped file is not terminated)
+     * @length - output length of line
+     *
+     * @return - 1 if line was loaded
+     *         - 0 on end of input
+     */
+
+    if (!reader->file_input)
+    {
+        // Switch buffers so previous line is not overwritten
+        int current = reader->current_buffer = !reader->current_buffer;
+
+        // Buffer is grown to length of the longest line
+        if (getline(&reader->buffers[current], &reader->buffer_sizes[current], stdin) < 0)
+            return 0;
+
+        *line = reader->buffers[current];
+        *length = rm_newline_chars(*line);
+        return 1;
+    }
+
+    // Line that starts in byte range is read whole
+    if (reader->position >= reader->range_end)
+        return 0;
+
+    return split_next_line(reader->data, reader->size, &reader->position, line, length);
+}
+
+void close_input(InputReader *reader)
+{
+    /*
+     * Release resources of input reader
+     *
+     * params:
+     * @reader - structure with reader data
+     */
+
+    if (reader->data != NULL)
+        munmap(reader->data, reader->size);
+
+    reader->data = NULL;
+
+    free(reader->carry);
+    reader->carry = NULL;
+
+    free(reader->buffers[0]);
+    free(reader->buffers[1]);
+    reader->buffers[0] = reader->buffers[1] = NULL;
+}
+
+void set_input_range(InputReader *reader, size_t start, size_t end)
+{
+    /*
+     * Limit reading of mapped file to lines that start in byte range
+     * Line that starts before the range belongs to previous range, so reading starts after first new line before start
+     *
+     * params:
+     * @reader - structure with reader data
+     * @start - first byte of range
+     * @end - byte after the range
+     */
+
+    if (end > reader->size)
+        end = reader->size;
+
+    reader->range_end = end;
+    reader->position = reader->size;
+
+    if (start == 0)
+        reader->position = 0;
+    else if (start < reader->size)
+    {
+        char *new_line = memchr(reader->data + start - 1, '\n', reader->size - start + 1);
+        if (new_line != NULL)
+            reader->position = (size_t)(new_line - reader->data) + 1;
+    }
+}
+
+int is_input_empty(const InputReader *reader)
+{
+    /*
+     * Check if there are no data in whole input when no line was read (byte range can be empty in non empty file)
+     *
+     * params:
+     * @reader - structure with reader data
+     *
+     * @return - 1 if input is empty
+     *         - 0 if not
+     */
+
+    return !reader->file_input || reader->size == 0;
+}
+
+int is_input_at_end(const InputReader *reader)
+{
+    /*
+     * Check if whole input was read (byte range can end before end of file)
+     *
+     * params:
+     * @reader - structure with reader data
+     *
+     * @return - 1 if input is at end
+     *         - 0 if not
+     */
+
+    return !reader->file_input || reader->position >= reader->size;
+}
+
+int read_input_chunk(InputReader *reader, Chunk *chunk)
+{
+    /*
+     * Load next chunk of whole lines from input
+     * Chunk of mapped file is not copied, chunk of stdin is read to buffer of chunk
+     * Chunk which is not last always ends with new line and there is at least one character after it
+     *
+     * params:
+     * @reader - structure with reader data
+     * @chunk - structure for loaded chunk
+     *
+     * @return - 1 if chunk was loaded
+     *         - 0 on end of input
+     *         - -1 on error
+     */
+
+    if (reader->file_input)
+    {
+        if (reader->position >= reader->range_end)
+            return 0;
+
+        size_t start = reader->position;
+        size_t end = start + CHUNK_SIZE;
+
+        if (end > reader->range_end)
+            end = reader->range_end;
+
+        // Chunk ends after end of line where the chunk size (or end of byte range) is reached
+        char *new_line = memchr(reader->data + end - 1, '\n', reader->size - end + 1);
+        end = new_line == NULL ? reader->size : (size_t)(new_line - reader->data) + 1;
+
+        chunk->data = reader->data + start;
+        chunk->size = end - start;
+        chunk->last_chunk = end == reader->size;
+        reader->position = end;
+        return 1;
+    }
+
+    if (reader->end_of_input && reader->carry_length == 0)
+        return 0;
+
+    if (chunk->buffer_capacity < CHUNK_SIZE || chunk->buffer_capacity < reader->carry_length)
+    {
+        size_t capacity = CHUNK_SIZE;
+        while (capacity < reader->carry_length)
+            capacity *= 2;
+
+        char *buffer = realloc(chunk->buffer, capacity);
+        if (buffer == NULL)
+        {
+            fprintf(stderr, "Cant allocate input buffer\n");
+            return -1;
+        }
+
+        chunk->buffer = buffer;
+        chunk->buffer_capacity = capacity;
+    }
+
+    // Chunk starts with rest of previous read
+    size_t length = reader->carry_length;
+    if (length > 0)
+        memcpy(chunk->buffer, reader->carry, length);
+    reader->carry_length = 0;
+
+    while (1)
+    {
+        if (!reader->end_of_input)
+        {
+            length += fread(chunk->buffer + length, 1, chunk->buffer_capacity - length, stdin);
+
+            // Buffer is not filled only on end of input (or read error)
+            if (length < chunk->buffer_capacity)
+                reader->end_of_input = 1;
+        }
+
+        if (reader->end_of_input)
+        {
+            chunk->data = chunk->buffer;
+            chunk->size = length;
+            chunk->last_chunk = 1;
+            return length > 0;
+        }
+
+        // Find last new line that is not last character, so it is sure that chunk is not last
+        size_t end = length - 1;
+        while (end > 0 && chunk->buffer[end - 1] != '\n')
+            end--;
+
+        if (end > 0)
+        {
+            size_t rest = length - end;
+            if (reader->carry_capacity < rest)
+            {
+                char *carry = realloc(reader->carry, rest);
+                if (carry == NULL)
+                {
+                    fprintf(stderr, "Cant allocate input buffer\n");
+                    return -1;
+                }
+
+                reader->carry = carry;
+                reader->carry_capacity = rest;
+            }
+
+            memcpy(reader->carry, chunk->buffer + end, rest);
+            reader->carry_length = rest;
+
+            chunk->data = chunk->buffer;
+            chunk->size = end;
+            chunk->last_chunk = 0;
+            return 1;
+        }
+
+        // Line is longer than buffer
+        char *buffer = realloc(chunk->buffer, chunk->buffer_capacity * 2);
+        if (buffer == NULL)
+        {
+            fprintf(stderr, "Cant allocate input buffer\n");
+            return -1;
+        }
+
+        chunk->buffer = buffer;
+        chunk->buffer_capacity *= 2;
+    }
+}
+
+int count_chunk_lines(const Chunk *chunk)
+{
+    /*
+     * Count lines in chunk
+     *
+     * params:
+     * @chunk - structure with chunk data
+     *
+     * @return - number of lines
+     */
+
+    int num_of_lines = 0;
+    const char *position = chunk->data;
+    const char *end = chunk->data + chunk->size;
+
+    while ((position = memchr(position, '\n', (size_t)(end - position))) != NULL)
+    {
+        num_of_lines++;
+        position++;
+    }
+
+    // Last line of input doesnt have to end with new line
+    if (chunk->size > 0 && chunk->data[chunk->size - 1] != '\n')
+        num_of_lines++;
+
+    return num_of_lines;
+}
+
+void process_chunk(WorkerPool *pool, Chunk *chunk, Line *line)
+{
+    /*
+     * Process all lines of chunk to output buffer of chunk
+     *
+     * params:
+     * @pool - structure with shared processing state
+     * @chunk - structure with chunk data
+     * @line - line structure of worker
+     */
+
+    chunk->output.length = 0;
+    chunk->output.error_flag = NO_ERROR;
+
+    line->output = &chunk->output;
+    line->line_index = chunk->first_line_index;
+    line->num_of_cols = pool->num_of_cols;
+    line->final_cols = pool->num_of_cols;
+    line->error_flag = NO_ERROR;
+    line->error_message[0] = 0;
+
+    size_t position = 0;
+    char *line_string;
+    int line_len;
+
+    while (split_next_line(chunk->data, chunk->size, &position, &line_string, &line_len))
+    {
+        line->last_line_flag = chunk->last_chunk && position >= chunk->size;
+        load_line_string(line, line_string, line_len);
+
+        // Keep reference to unedited line
+        line->unedited_line_string = line_string;
+        line->unedited_line_len = line_len;
+
+        process_line(line, pool->selector, pool->program, 0);
+        if (line->error_flag || chunk->output.error_flag)
+            break;
+
+        // Writer stopped, output wont be used
+        if (__atomic_load_n(&pool->stop, __ATOMIC_RELAXED))
+            break;
+    }
+
+    chunk->final_cols = line->final_cols;
+    chunk->error_flag = line->error_flag;
+    memcpy(chunk->error_message, line->error_message, ERROR_MESSAGE_LEN);
+}
+
+int init_ring(RingBuffer *ring, int min_capacity)
+{
+    /*
+     * Allocate ring buffer
+     *
+     * params:
+     * @ring - structure with ring buffer data
+     * @min_capacity - minimal number of values in ring (capacity is rounded to power of 2)
+     *
+     * @return - NO_ERROR on success
+     *         - INPUT_ERROR if ring cant be allocated
+     */
+
+    size_t capacity = 2;
+    while (capacity < (size_t)min_capacity)
+        capacity *= 2;
+
+    ring->cells = malloc(capacity * sizeof(RingCell));
+    if (ring->cells == NULL)
+        return INPUT_ERROR;
+
+    for (size_t i = 0; i < capacity; i++)
+        ring->cells[i].sequence = i;
+
+    ring->mask = capacity - 1;
+    ring->push_position = 0;
+    ring->pop_position = 0;
+    return NO_ERROR;
+}
+
+int ring_push(RingBuffer *ring, int value)
+{
+    /*
+     * Push value to ring buffer
+     *
+     * params:
+     * @ring - structure with ring buffer data
+     * @value - value to push
+     *
+     * @return - 1 on success
+     *         - 0 if ring is full
+     */
+
+    size_t position = __atomic_load_n(&ring->push_position, __ATOMIC_RELAXED);
+
+    while (1)
+    {
+        RingCell *cell = &ring->cells[position & ring->mask];
+        size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+        if (difference == 0)
+        {
+            // Cell is free, take the position (on fail position is updated to current one)
+            if (__atomic_compare_exchange_n(&ring->push_position, &position, position + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                cell->value = value;
+                __atomic_store_n(&cell->sequence, position + 1, __ATOMIC_RELEASE);
+                return 1;
+            }
+        }
+        else if (difference < 0)
+            return 0;
+        else
+            position = __atomic_load_n(&ring->push_position, __ATOMIC_RELAXED);
+    }
+}
+
+int ring_pop(RingBuffer *ring, int *value)
+{
+    /*
+     * Pop value from ring buffer
+     *
+     * params:
+     * @ring - structure with ring buffer data
+     * @value - output popped value
+     *
+     * @return - 1 on success
+     *         - 0 if ring is empty
+     */
+
+    size_t position = __atomic_load_n(&ring->pop_position, __ATOMIC_RELAXED);
+
+    while (1)
+    {
+        RingCell *cell = &ring->cells[position & ring->mask];
+        size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+
+        if (difference == 0)
+        {
+            if (__atomic_compare_exchange_n(&ring->pop_position, &position, position + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                *value = cell->value;
+                // Cell will be free for push one round later
+                __atomic_store_n(&cell->sequence, position + ring->mask + 1, __ATOMIC_RELEASE);
+                return 1;
+            }
+        }
+        else if (difference < 0)
+            return 0;
+        else
+            position = __atomic_load_n(&ring->pop_position, __ATOMIC_RELAXED);
+    }
+}
+
+void wait_backoff(int *spins)
+{
+    /*
+     * Wait before next try to pop from ring buffer
+     * Short waits are spinned, long waits (slow input) sleep so idle threads dont take cpu from others
+     *
+     * params:
+     * @spins - number of waits since last successful pop
+     */
+
+    if (*spins < BACKOFF_SPINS)
+    {
+#ifdef X86_SIMD
+        _mm_pause();
+#endif
+    }
+    else if (*spins < 2 * BACKOFF_SPINS)
+        sched_yield();
+    else
+    {
+        struct timespec sleep_time = {0, BACKOFF_SLEEP_NS};
+        nanosleep(&sleep_time, NULL);
+        return;
+    }
+
+    (*spins)++;
+}
+
+int count_first_line_cells(Line *line, char *data, size_t size)
+{
+    /*
+     * Get number of cells of first line in block of input data
+     *
+     * params:
+     * @line - structure for line data
+     * @data - block of input data
+     * @size - size of block (not 0)
+     *
+     * @return - number of cells
+     */
+
+    size_t position = 0;
+    char *line_string;
+    int line_len;
+
+    if (!split_next_line(data, size, &position, &line_string, &line_len))
+        return 0;
+
+    load_line_string(line, line_string, line_len);
+    return get_number_of_cells(line);
+}
+
+double get_time(void)
+{
+    /*
+     * Get time from monotonic clock
+     *
+     * @return - time in seconds
+     */
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+void assign_chunk(WorkerPool *pool, int slot)
+{
+    /*
+     * Put read chunk to queue of worker with least bytes waiting for processing
+     *
+     * params:
+     * @pool - structure with shared processing state
+     * @slot - slot of read chunk
+     */
+
+    Worker *target = &pool->workers[0];
+    size_t target_bytes = __atomic_load_n(&target->queued_bytes, __ATOMIC_RELAXED);
+
+    for (int i = 1; i < pool->num_of_workers && target_bytes > 0; i++)
+    {
+        size_t queued_bytes = __atomic_load_n(&pool->workers[i].queued_bytes, __ATOMIC_RELAXED);
+        if (queued_bytes < target_bytes)
+        {
+            target = &pool->workers[i];
+            target_bytes = queued_bytes;
+        }
+    }
+
+    // Queue of every worker has space for all slots so it is never full
+    __atomic_fetch_add(&target->queued_bytes, pool->chunks[slot].size, __ATOMIC_RELAXED);
+    ring_push(&target->tasks, slot);
+}
+
+int take_chunk(Worker *worker, int *slot)
+{
+    /*
+     * Take chunk from own queue of worker, when it is empty steal oldest chunk from queue of other worker
+     *
+     * params:
+     * @worker - structure with worker data
+     * @slot - output slot of taken chunk
+     *
+     * @return - 1 if chunk was taken
+     *         - 0 if all queues are empty
+     */
+
+    WorkerPool *pool = worker->pool;
+
+    for (int i = 0; i < pool->num_of_workers; i++)
+    {
+        Worker *victim = &pool->workers[(worker->id + i) % pool->num_of_workers];
 
-        if (get_value_of_cell(line, source_index - 1, cell_buff) == 0)
+        if (ring_pop(&victim->tasks, slot))
         {
-            if (source_index < target_index)
-            {
-                // Insert empty cell before target cell
-                if (insert_empty_cell(line, target_index - 1) != 0)
-                    return;
+            __atomic_fetch_sub(&victim->queued_bytes, pool->chunks[*slot].size, __ATOMIC_RELAXED);
+            if (victim != worker)
+                worker->num_of_stolen++;
 
-                // Remove original cell
-                remove_cell(line, source_index - 1);
-                // Insert value to before created empty cell
-                insert_to_cell(line, target_index - 2, cell_buff);
-            }
-            else
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+void *chunk_reader(void *arg)
+{
+    /*
+     * Thread function of reader, reads chunks to free slots and passes them to workers
+     *
+     * params:
+     * @arg - worker pool structure
+     *
+     * @return - NULL
+     */
+
+    WorkerPool *pool = arg;
+    long sequence = 0;
+    int line_index = pool->line_settings->line_index;
+    int spins = 0;
+    int slot;
+
+    while (!__atomic_load_n(&pool->stop, __ATOMIC_RELAXED) &&
+           sequence <= __atomic_load_n(&pool->error_sequence, __ATOMIC_RELAXED))
+    {
+        // Wait for writer to release some slot
+        if (!ring_pop(&pool->free_chunks, &slot))
+        {
+            wait_backoff(&spins);
+            continue;
+        }
+        spins = 0;
+
+        Chunk *chunk = &pool->chunks[slot];
+        int ret = read_input_chunk(pool->reader, chunk);
+
+        if (ret <= 0)
+        {
+            if (ret < 0)
+                pool->reader_error = INPUT_ERROR;
+            else if (sequence == 0 && is_input_empty(pool->reader))
             {
-                // Insert empty cell before target cell
-                if (insert_empty_cell(line, target_index - 1) != 0)
-                    return;
+                fprintf(stderr, "Input cant be empty");
+                pool->reader_error = INPUT_ERROR;
+            }
+            break;
+        }
 
-                // Remove original cell
-                remove_cell(line, source_index);
-                // Insert value to before created empty cell
-                insert_to_cell(line, target_index - 1, cell_buff);
+        // Reference number of cols is taken from first line of input (if it was not taken from whole file before)
+        if (pool->num_of_cols < 0)
+        {
+            Line *first_line = calloc(1, sizeof(Line));
+            if (first_line == NULL)
+            {
+                fprintf(stderr, "Cant allocate memory for workers\n");
+                pool->reader_error = INPUT_ERROR;
+                break;
             }
+
+            first_line->delim = pool->line_settings->delim;
+            first_line->delim_set = pool->line_settings->delim_set;
+            pool->num_of_cols = count_first_line_cells(first_line, chunk->data, chunk->size);
+            free_line(first_line);
+            free(first_line);
         }
+
+        chunk->sequence = sequence++;
+        chunk->first_line_index = line_index;
+        line_index = advance_line_index(pool->program, line_index, count_chunk_lines(chunk));
+        pool->read_bytes += chunk->size;
+
+        assign_chunk(pool, slot);
+
+        if (chunk->last_chunk)
+            break;
     }
+
+    pool->num_of_chunks = sequence;
+    __atomic_store_n(&pool->reader_done, 1, __ATOMIC_RELEASE);
+    return NULL;
 }
 
-void row_values_processing(Line *line, int output_index, int start_index, int end_index, int function_flag)
+void *chunk_worker(void *arg)
 {
     /*
-     * Process cells with index in inputed interval by function selected by flag
-     * Supported functions: SUM - sum of selected number cells
-     *                      AVG - count average value of selected number cells
-     *                      MIN - minimum value of selected number cells
-     *                      MAX - maximum value of selected number cells
-     *                      COUNT - count number of non empty cells
+     * Thread function of worker, processes read chunks until reader is done or processing is stopped
      *
      * params:
-     * @line - structure with line data
-     * @output_index - index of cell where to output processed value
-     * @start_index - start index of processing interval
-     * @end_index - end index of processing interval
-     * @function_flag - flag of function to use
+     * @arg - worker structure
+     *
+     * @return - NULL
      */
 
-    if (is_cell_index_valid(line, output_index) &&
-        (output_index < start_index || output_index > end_index))
+    Worker *worker = arg;
+    WorkerPool *pool = worker->pool;
+    int spins = 0;
+    int slot;
+
+    while (!__atomic_load_n(&pool->stop, __ATOMIC_RELAXED))
+    {
+        // Reader state is checked before taking chunk, so empty queues after reader is done means there wont be more chunks
+        int reader_done = __atomic_load_n(&pool->reader_done, __ATOMIC_ACQUIRE);
+
+        if (!take_chunk(worker, &slot))
+        {
+            if (reader_done)
+                break;
+
+            wait_backoff(&spins);
+            continue;
+        }
+        spins = 0;
+
+        Chunk *chunk = &pool->chunks[slot];
+        long error_sequence = __atomic_load_n(&pool->error_sequence, __ATOMIC_RELAXED);
+
+        // Chunks after failed chunk are never written
+        if (chunk->sequence > error_sequence)
+        {
+            chunk->output.length = 0;
+            chunk->error_flag = NO_ERROR;
+        }
+        else
+        {
+            double start_time = get_time();
+            process_chunk(pool, chunk, worker->line);
+            worker->busy_time += get_time() - start_time;
+            worker->processed_bytes += chunk->size;
+            worker->num_of_chunks++;
+        }
+
+        // Keep sequence number of first failed chunk
+        while ((chunk->error_flag || chunk->output.error_flag) && chunk->sequence < error_sequence &&
+               !__atomic_compare_exchange_n(&pool->error_sequence, &error_sequence, chunk->sequence, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+        ring_push(&pool->processed_chunks, slot);
+    }
+
+    return NULL;
+}
+
+int get_byte_range(int argc, char *argv[], size_t *start, size_t *end)
+{
+    /*
+     * Get byte range from --byte-range START:END argument, END can be omitted for range to end of file
+     *
+     * params:
+     * @argc - length of argument array
+     * @argv - argument array
+     * @start - output first byte of range
+     * @end - output byte after the range
+     *
+     * @return - 1 if byte range is set
+     *         - 0 when argument is not used
+     *         - -1 if argument is invalid
+     */
+
+    char *range_arg = get_opt(argc, argv, "--byte-range");
+    if (range_arg == NULL)
+        return 0;
+
+    char *rest;
+    errno = 0;
+    *start = (size_t)strtoull(range_arg, &rest, 10);
+    *end = SIZE_MAX;
+
+    if (!isdigit((unsigned char)range_arg[0]) || rest[0] != ':' || errno != 0)
+    {
+        fprintf(stderr, "Invalid byte range %s\n", range_arg);
+        return -1;
+    }
+
+    char *end_arg = rest + 1;
+    if (end_arg[0] != 0)
+    {
+        *end = (size_t)strtoull(end_arg, &rest, 10);
+        if (!isdigit((unsigned char)end_arg[0]) || rest[0] != 0 || errno != 0 || *end < *start)
+        {
+            fprintf(stderr, "Invalid byte range %s\n", range_arg);
+            return -1;
+        }
+    }
+
+    return 1;
+}
+
+int get_row_offset(int argc, char *argv[])
+{
+    /*
+     * Get number of input lines before processed part of input from --row-offset argument
+     *
+     * params:
+     * @argc - length of argument array
+     * @argv - argument array
+     *
+     * @return - row offset (0 when argument is not used)
+     *         - -1 if argument is invalid
+     */
+
+    char *offset_arg = get_opt(argc, argv, "--row-offset");
+    if (offset_arg == NULL)
+        return 0;
+
+    int row_offset;
+    if (!is_string_int(offset_arg) || string_to_int(offset_arg, &row_offset) != 0 || row_offset < 0)
+    {
+        fprintf(stderr, "Invalid row offset %s\n", offset_arg);
+        return -1;
+    }
+
+    return row_offset;
+}
+
+int get_number_of_threads(int argc, char *argv[])
+{
+    /*
+     * Get number of processing threads from -j argument
+     *
+     * params:
+     * @argc - length of argument array
+     * @argv - argument array
+     *
+     * @return - number of worker threads (number of processors for 0)
+     *         - 0 when argument is not used (input is processed without threads)
+     *         - -1 if argument is invalid
+     */
+
+    char *threads_arg = get_opt(argc, argv, "-j");
+    if (threads_arg == NULL)
+        return 0;
+
+    int num_of_threads;
+    if (!is_string_int(threads_arg) || string_to_int(threads_arg, &num_of_threads) != 0 || num_of_threads < 0)
+    {
+        fprintf(stderr, "Invalid number of threads %s\n", threads_arg);
+        return -1;
+    }
+
+    if (num_of_threads == 0)
+    {
+        long num_of_processors = sysconf(_SC_NPROCESSORS_ONLN);
+        num_of_threads = num_of_processors > 0 ? (int)num_of_processors : 1;
+    }
+
+    return num_of_threads > MAX_THREADS ? MAX_THREADS : num_of_threads;
+}
+
+int process_input(InputReader *reader, Selector *selector, const Program *program, Line *line_holder, int print_stats)
+{
+    /*
+     * Process input line by line
+     *
+     * params:
+     * @reader - structure with reader data
+     * @selector - structure with selector params
+     * @program - compiled commands
+     * @line_holder - structure for line data
+     * @print_stats - flag to print statistics to stderr
+     *
+     * @return - NO_ERROR on success
+     *         - error code of first error
+     */
+
+    char *line, *next_line;
+    int line_len, next_line_len;
+    double start_time = get_time();
+    long num_of_lines = 0;
+
+    int has_next_line = read_input_line(reader, &next_line, &next_line_len);
+    if (!has_next_line && is_input_empty(reader))
+    {
+        fprintf(stderr, "Input cant be empty");
+        return INPUT_ERROR;
+    }
+
+    // Iterate over lines
+    while (has_next_line)
+    {
+        // Take line from buffer
+        line = next_line;
+        line_len = next_line_len;
+        // Load new line to buffer, line is last only when byte range ends with end of input
+        has_next_line = read_input_line(reader, &next_line, &next_line_len);
+        line_holder->last_line_flag = !has_next_line && is_input_at_end(reader);
+
+        // Rows after last selectable row dont change statistics of columns or groups
+        if ((program->operating_mode == COLUMN_STATS || program->operating_mode == GROUP_BY) && line_holder->line_index >= program->first_passed_row)
+            break;
+
+        // Other delims are replaced with main delim when line is scanned
+        load_line_string(line_holder, line, line_len);
+        num_of_lines++;
+
+        // Keep reference to unedited line
+        line_holder->unedited_line_string = line;
+        line_holder->unedited_line_len = line_len;
+
+        if (line_holder->num_of_cols < 0)
+            line_holder->num_of_cols = get_number_of_cells(line_holder);
+
+        process_line(line_holder, selector, program, 0);
+        if (line_holder->error_flag)
+        {
+            fputs(line_holder->error_message, stderr);
+            return line_holder->error_flag;
+        }
+
+        // Stop processing when output cant be written
+        if (line_holder->output->error_flag)
+            return line_holder->output->error_flag;
+    }
+
+    if (print_stats)
+        fprintf(stderr, "Stats: %ld lines, %.3f s\n", num_of_lines, get_time() - start_time);
+
+    return NO_ERROR;
+}
+
+int process_input_parallel(InputReader *reader, Selector *selector, const Program *program, Line *line_holder, int num_of_threads, int print_stats)
+{
+    /*
+     * Process input in pipeline of threads
+     * Reader thread reads chunks of lines and computes their global line indexes, worker threads process chunks
+     * and caller thread writes processed chunks in order of input
+     * Threads pass slots of chunks by lock-free ring buffers, number of slots limits how far reader can go ahead
+     * Chunks are assigned to workers by size in bytes and idle workers steal chunks from busy ones
+     *
+     * params:
+     * @reader - structure with reader data
+     * @selector - structure with selector params
+     * @program - compiled commands
+     * @line_holder - structure with line settings, it gets number of cols and final cols of last line
+     * @num_of_threads - number of worker threads
+     * @print_stats - flag to print statistics of workers to stderr
+     *
+     * @return - NO_ERROR on success
+     *         - error code of first error
+     */
+
+    int error_flag = NO_ERROR;
+    double start_time = get_time();
+
+    WorkerPool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.num_of_slots = num_of_threads * CHUNKS_PER_THREAD;
+    pool.reader = reader;
+    pool.error_sequence = LONG_MAX;
+    pool.program = program;
+    pool.selector = selector;
+    pool.line_settings = line_holder;
+    pool.num_of_cols = line_holder->num_of_cols;
+
+    pool.chunks = calloc((size_t)pool.num_of_slots, sizeof(Chunk));
+    pool.workers = calloc((size_t)num_of_threads, sizeof(Worker));
+    pool.num_of_workers = num_of_threads;
+    // Slot of processed chunk by its sequence number (modulo number of slots), -1 if chunk is not processed yet
+    int *processed_slots = malloc((size_t)pool.num_of_slots * sizeof(int));
+
+    if (pool.chunks == NULL || pool.workers == NULL || processed_slots == NULL ||
+        init_ring(&pool.free_chunks, pool.num_of_slots) != NO_ERROR ||
+        init_ring(&pool.processed_chunks, pool.num_of_slots) != NO_ERROR)
+    {
+        fprintf(stderr, "Cant allocate memory for workers\n");
+        error_flag = INPUT_ERROR;
+    }
+
+    for (int i = 0; i < num_of_threads && error_flag == NO_ERROR; i++)
+    {
+        Worker *worker = &pool.workers[i];
+        worker->pool = &pool;
+        worker->id = i;
+        worker->line = calloc(1, sizeof(Line));
+
+        if (worker->line == NULL || init_ring(&worker->tasks, pool.num_of_slots) != NO_ERROR)
+        {
+            fprintf(stderr, "Cant allocate memory for workers\n");
+            error_flag = INPUT_ERROR;
+            break;
+        }
+
+        worker->line->delim = line_holder->delim;
+        worker->line->delim_set = line_holder->delim_set;
+    }
+
+    for (int i = 0; i < pool.num_of_slots && error_flag == NO_ERROR; i++)
+    {
+        error_flag = init_output(&pool.chunks[i].output, -1, CHUNK_SIZE);
+        processed_slots[i] = -1;
+        ring_push(&pool.free_chunks, i);
+    }
+
+    pthread_t reader_thread;
+    int reader_started = 0;
+    if (error_flag == NO_ERROR)
+    {
+        if (pthread_create(&reader_thread, NULL, chunk_reader, &pool) != 0)
+        {
+            fprintf(stderr, "Cant start reader thread\n");
+            error_flag = INPUT_ERROR;
+        }
+        else
+            reader_started = 1;
+    }
+
+    // Chunks in queues of workers that didnt start are stolen by others
+    int num_of_started = 0;
+    for (; num_of_started < num_of_threads && error_flag == NO_ERROR; num_of_started++)
+    {
+        if (pthread_create(&pool.workers[num_of_started].thread, NULL, chunk_worker, &pool.workers[num_of_started]) != 0)
+        {
+            // Continue with threads that were already started
+            if (num_of_started == 0)
+            {
+                fprintf(stderr, "Cant start worker threads\n");
+                error_flag = INPUT_ERROR;
+            }
+            break;
+        }
+    }
+
+    long num_of_written = 0;
+    int spins = 0;
+    int slot;
+
+    while (error_flag == NO_ERROR)
+    {
+        int reader_done = __atomic_load_n(&pool.reader_done, __ATOMIC_ACQUIRE);
+
+        if (!ring_pop(&pool.processed_chunks, &slot))
+        {
+            // All chunks are written
+            if (reader_done && num_of_written == pool.num_of_chunks)
+            {
+                error_flag = pool.reader_error;
+                break;
+            }
+
+            wait_backoff(&spins);
+            continue;
+        }
+        spins = 0;
+
+        processed_slots[pool.chunks[slot].sequence % pool.num_of_slots] = slot;
+
+        // Write processed chunks in order of input, their slots are released for reader
+        while (error_flag == NO_ERROR && (slot = processed_slots[num_of_written % pool.num_of_slots]) >= 0)
+        {
+            Chunk *chunk = &pool.chunks[slot];
+            processed_slots[num_of_written % pool.num_of_slots] = -1;
+
+            // Lines processed before error are still written
+            write_to_output(line_holder->output, chunk->output.data, chunk->output.length);
+            num_of_written++;
+
+            if (chunk->error_flag)
+            {
+                fputs(chunk->error_message, stderr);
+                error_flag = chunk->error_flag;
+            }
+            else if (chunk->output.error_flag)
+                error_flag = chunk->output.error_flag;
+            else if (line_holder->output->error_flag)
+                error_flag = line_holder->output->error_flag;
+            else if (chunk->last_chunk)
+            {
+                line_holder->final_cols = chunk->final_cols;
+                line_holder->last_line_flag = 1;
+            }
+
+            ring_push(&pool.free_chunks, slot);
+        }
+    }
+
+    // Stop all threads, chunks that were not written yet are dropped
+    __atomic_store_n(&pool.stop, 1, __ATOMIC_RELAXED);
+
+    if (reader_started)
+    {
+        // Reader can wait for data from slow input, it is not needed anymore after error
+        if (error_flag != NO_ERROR)
+            pthread_cancel(reader_thread);
+
+        pthread_join(reader_thread, NULL);
+    }
+
+    for (int i = 0; i < num_of_started; i++)
+        pthread_join(pool.workers[i].thread, NULL);
+
+    line_holder->num_of_cols = pool.num_of_cols;
+
+    if (print_stats)
+    {
+        double wall_time = get_time() - start_time;
+
+        fprintf(stderr, "Stats: %ld chunks, %zu bytes, %d workers, %.3f s\n", pool.num_of_chunks, pool.read_bytes, num_of_started, wall_time);
+        for (int i = 0; i < num_of_started; i++)
+        {
+            Worker *worker = &pool.workers[i];
+            fprintf(stderr, "Worker %d: %ld chunks (%ld stolen), %zu bytes, busy %.3f s, utilization %.1f %%\n",
+                    i, worker->num_of_chunks, worker->num_of_stolen, worker->processed_bytes, worker->busy_time,
+                    wall_time > 0 ? 100.0 * worker->busy_time / wall_time : 0.0);
+        }
+    }
+
+    for (int i = 0; pool.workers != NULL && i < num_of_threads; i++)
     {
-        double setval;
-        char cell_buff[MAX_CELL_LEN + 1];
-        int processed_cells;
+        if (pool.workers[i].line != NULL)
+            free_line(pool.workers[i].line);
 
-        if ((processed_cells = process_row_values(line, start_index, end_index, &setval, function_flag)) == -1)
-            return;
+        free(pool.workers[i].line);
+        free(pool.workers[i].tasks.cells);
+    }
 
-        if (function_flag == AVG)
-            setval /= processed_cells;
+    for (int i = 0; pool.chunks != NULL && i < pool.num_of_slots; i++)
+    {
+        free(pool.chunks[i].output.data);
+        free(pool.chunks[i].buffer);
+    }
 
-        // Check if double can be converted to int without loss
-        if (is_double_int(setval))
-            snprintf(cell_buff, MAX_CELL_LEN + 1, "%d", (int)setval);
-        else
-            snprintf(cell_buff, MAX_CELL_LEN + 1, "%lf", setval);
+    free(pool.free_chunks.cells);
+    free(pool.processed_chunks.cells);
+    free(processed_slots);
+    free(pool.chunks);
+    free(pool.workers);
 
-        set_value_in_cell(line, output_index, cell_buff);
-    }
+    return error_flag;
 }
 
-void row_sequence_gen(Line *line, int start_index, int end_index, int start_value)
+int get_batch_start(int argc, char *argv[])
 {
     /*
-     * Create sequence of number starting from start value in cells with index from inputed interval
+     * Find separator of commands and list of input files of batch
+     * Operands of commands are skipped, so string argument "--" (cset 1 --) isnt taken as separator
      *
      * params:
-     * @line - structure with line data
-     * @start_index - start index of processing interval
-     * @end_index - end index of processing interval
-     * @start_value - start value of number sequence
+     * @argc - length of argument array
+     * @argv - argument array
+     *
+     * @return - index of separator, arguments before it are commands and arguments after it are input files
+     *         - -1 when list of files is not used
      */
 
-    if (is_cell_index_valid(line, start_index) && end_index > 0)
+    for (int i = 1; i < argc - 1; i += 1 + get_number_of_operands(argv[i]))
     {
-        char cell_buff[MAX_CELL_LEN + 1];
-
-        for (int i = start_index; i <= end_index; i++, start_value++)
-        {
-            snprintf(cell_buff, MAX_CELL_LEN + 1, "%d", start_value);
-            if (set_value_in_cell(line, i, cell_buff) != 0)
-                return;
-        }
+        if (strings_equal(argv[i], BATCH_SEPARATOR))
+            return i;
     }
+
+    return -1;
 }
 
-void table_edit(Line *line, char *line_buffer, int argc, char *argv[], int com_index)
+void write_output_end(OutputBuffer *output, const Line *line_holder, const Selector *selector, int argc, char *argv[])
 {
     /*
-     * Function to apply table edit command to line
+     * Write end of output after all lines of input are processed
      *
      * params:
-     * @line - structure with line data
-     * @argc - lenght of argument array
+     * @output - structure with output buffer data
+     * @line_holder - structure with line data after last line
+     * @selector - structure with selector params
+     * @argc - length of argument array
      * @argv - argument array
-     * @com_index - index of command to use
      */
 
-    if (line->error_flag)
-        return;
-
-    switch (get_table_com_index(argv[com_index]))
-    {
-        // TODO: Make row indexing consistent after removing/adding lines
-        case 0:
-            // irow R
-            create_emty_row_at(line, line_buffer, argument_to_int(argv, argc, com_index + 1));
-            break;
-
-        case 2:
-            // drow R
-            delete_rows_in_interval(line, argument_to_int(argv, argc, com_index + 1), argument_to_int(argv, argc, com_index + 1));
-            break;
-
-        case 3:
-            // drows N M
-            delete_rows_in_interval(line, argument_to_int(argv, argc, com_index + 1), argument_to_int(argv, argc, com_index + 2));
-            break;
-
-        case 4:
-            // icol C
-            insert_empty_cell_at(line, argument_to_int(argv, argc, com_index + 1));
-            break;
-
-        case 5:
-            // acol
-            append_empty_cell(line);
-            break;
-
-        case 6:
-            // dcol C
-            delete_cells_in_interval(line, argument_to_int(argv, argc, com_index + 1), argument_to_int(argv, argc, com_index + 1));
-            break;
+#ifdef DEBUG
+    print_to_output(output, "\n\nDebug:\n");
 
-        case 7:
-            // dcols N M
-            delete_cells_in_interval(line, argument_to_int(argv, argc, com_index + 1), argument_to_int(argv, argc, com_index + 2));
-            break;
+    print_to_output(output, "Base cols: %d Final cols: %d\n", line_holder->num_of_cols, line_holder->final_cols);
+    print_to_output(output, "Selector: type %d, a1: %s, a2: %s, str: %s\n", selector->selector_type, selector->a1, selector->a2, selector->str);
+    print_to_output(output, "Delim: '%c'\n", line_holder->delim);
 
-        default:
-            break;
+    print_to_output(output, "Args: ");
+    for (int i = 1; i < argc; i++)
+    {
+        print_to_output(output, "%s ", argv[i]);
     }
+#else
+    (void)line_holder;
+    (void)selector;
+    (void)argc;
+    (void)argv;
+#endif
+
+    write_char_to_output(output, '\n');
 }
 
-void data_edit(Line *line, int argc, char *argv[], int com_index)
+int process_file(BatchWorker *worker, const char *input_path)
 {
     /*
-     * Function to apply data edit command to line
+     * Process one input file of batch and write its output to file with OUTPUT_FILE_SUFFIX
      *
      * params:
-     * @line - structure with line data
-     * @argc - lenght of argument array
-     * @argv - argument array
-     * @com_index - index of command to use
+     * @worker - structure with thread data
+     * @input_path - path to input file
+     *
+     * @return - NO_ERROR on success
+     *         - error code of first error in file
      */
 
-    if (line->error_flag)
-        return;
+    Batch *batch = worker->batch;
 
-    // Edit line data only when its flagged as line to edit
-    if (line->process_flag)
+    size_t path_length = strlen(input_path);
+    char *output_path = malloc(path_length + sizeof(OUTPUT_FILE_SUFFIX));
+    if (output_path == NULL)
     {
-        switch (get_data_com_index(argv[com_index]))
-        {
-            case 0:
-                // cset C STR
-                if ((com_index + 2) < argc)
-                    set_value_in_cell(line, argument_to_int(argv, argc, com_index + 1), argv[com_index + 2]);
-                break;
-
-            case 1:
-                // tolower C
-                cell_value_editing(line, argument_to_int(argv, argc, com_index + 1), LOWER);
-                break;
+        fprintf(stderr, "Cant allocate memory for output path\n");
+        return OUTPUT_ERROR;
+    }
 
-            case 2:
-                // toupper C
-                cell_value_editing(line, argument_to_int(argv, argc, com_index + 1), UPPER);
-                break;
+    memcpy(output_path, input_path, path_length);
+    memcpy(output_path + path_length, OUTPUT_FILE_SUFFIX, sizeof(OUTPUT_FILE_SUFFIX));
 
-            case 3:
-                // round C
-                cell_value_editing(line, argument_to_int(argv, argc, com_index + 1), ROUND);
-                break;
+    if (open_input(worker->reader, input_path) != NO_ERROR)
+    {
+        free(output_path);
+        return INPUT_ERROR;
+    }
 
-            case 4:
-                // int C
-                cell_value_editing(line, argument_to_int(argv, argc, com_index + 1), INT);
-                break;
+    // Output file isnt created for invalid input, message is terminated so messages of other files start on new line
+    if (is_input_empty(worker->reader))
+    {
+        fprintf(stderr, "Input cant be empty\n");
+        free(output_path);
+        close_input(worker->reader);
+        return INPUT_ERROR;
+    }
 
-            case 5:
-                // copy N M
-                copy_cell_value_to(line, argument_to_int(argv, argc, com_index + 1), argument_to_int(argv, argc, com_index + 2));
-                break;
+    int fd = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Cant open output file %s\n", output_path);
+        free(output_path);
+        close_input(worker->reader);
+        return OUTPUT_ERROR;
+    }
 
-            case 6:
-                // swap N M
-                swap_cell_values(line, argument_to_int(argv, argc, com_index + 1), argument_to_int(argv, argc, com_index + 2));
-                break;
+    free(output_path);
 
-            case 7:
-                // move N M
-                move_cell_to(line, argument_to_int(argv, argc, com_index + 1), argument_to_int(argv, argc, com_index + 2));
-                break;
+    // Output buffer is reused for all files of thread
+    worker->output.fd = fd;
+    worker->output.length = 0;
+    worker->output.error_flag = NO_ERROR;
 
-            case 8:
-                // csum C N M
-                row_values_processing(line, argument_to_int(argv, argc, com_index + 1), argument_to_int(argv, argc, com_index + 2), argument_to_int(argv, argc, com_index + 3), SUM);
-                break;
+    // Line is reset to state before first line of input
+    Line *line_holder = worker->line;
+    line_holder->error_flag = NO_ERROR;
+    line_holder->error_message[0] = '\0';
+    line_holder->last_line_flag = 0;
+    line_holder->num_of_cols = -1;
+    line_holder->final_cols = 0;
+    line_holder->line_index = 0;
+    line_holder->num_of_stats_columns = 0;
+    free_group_table(&line_holder->groups);
 
-            case 9:
-                // cavg C N M
-                row_values_processing(line, argument_to_int(argv, argc, com_index + 1), argument_to_int(argv, argc, com_index + 2), argument_to_int(argv, argc, com_index + 3), AVG);
-                break;
+    int error_flag = process_input(worker->reader, batch->selector, batch->program, line_holder, 0);
 
-            case 10:
-                // cmin C N M
-                row_values_processing(line, argument_to_int(argv, argc, com_index + 1), argument_to_int(argv, argc, com_index + 2), argument_to_int(argv, argc, com_index + 3), MIN);
-                break;
+    worker->processed_bytes += worker->reader->size;
+    close_input(worker->reader);
 
-            case 11:
-                // cmax C N M
-                row_values_processing(line, argument_to_int(argv, argc, com_index + 1), argument_to_int(argv, argc, com_index + 2), argument_to_int(argv, argc, com_index + 3), MAX);
-                break;
+    // Lines processed before error are still written
+    if (error_flag == NO_ERROR)
+    {
+        if (batch->program->operating_mode == COLUMN_STATS)
+            write_column_stats(&worker->output, line_holder);
+        else if (batch->program->operating_mode == GROUP_BY)
+            error_flag = write_groups(&worker->output, &line_holder->groups, batch->program, line_holder->delim);
 
-            case 12:
-                // ccount C N M
-                row_values_processing(line, argument_to_int(argv, argc, com_index + 1), argument_to_int(argv, argc, com_index + 2), argument_to_int(argv, argc, com_index + 3), COUNT);
-                break;
+        if (error_flag == NO_ERROR)
+            write_output_end(&worker->output, line_holder, batch->selector, batch->argc, batch->argv);
+    }
 
-            case 13:
-                // cseq N M B
-                row_sequence_gen(line, argument_to_int(argv, argc, com_index + 1), argument_to_int(argv, argc, com_index + 2), argument_to_int(argv, argc, com_index + 3));
-                break;
+    flush_output(&worker->output);
+    if (error_flag == NO_ERROR)
+        error_flag = worker->output.error_flag;
 
-            default:
-                break;
-        }
+    if (close(fd) != 0 && error_flag == NO_ERROR)
+    {
+        fprintf(stderr, "Cant write output file of %s\n", input_path);
+        error_flag = OUTPUT_ERROR;
     }
+
+    return error_flag;
 }
 
-void process_line(Line *line, Selector *selector, int argc, char *argv[], int operating_mode, int last_line_executed)
+void *batch_worker(void *arg)
 {
     /*
-    Process loaded line data
+     * Thread of batch that processes files until all files are taken
+     *
+     * params:
+     * @arg - structure with thread data
+     *
+     * @return - NULL
+     */
 
-    params:
-    @line - structure with line data
-    @selector - structure with selector params
-    @argc - length of argument array
-    @argv - argument array
-    @operating_mode - operating mode of program
-    @last_line_executed - flag to indicate that last line is executed
-    */
+    BatchWorker *worker = arg;
+    Batch *batch = worker->batch;
 
-    // Initialize/clear line states
-    line->deleted = 0;
-    line->final_cols = line->num_of_cols;
+    for (;;)
+    {
+        int index = __atomic_fetch_add(&batch->next_file, 1, __ATOMIC_RELAXED);
+        if (index >= batch->num_of_files)
+            break;
 
-    // Check if data in line should be processed
-    validate_line_processing(line, selector);
+        double start_time = get_time();
+        batch->results[index] = process_file(worker, batch->files[index]);
+        worker->busy_time += get_time() - start_time;
+        worker->num_of_files++;
 
-    // Sanity of line
-    if (!check_line_sanity(line))
-        return;
+        if (batch->results[index] != NO_ERROR)
+            fprintf(stderr, "Processing of file %s failed\n", batch->files[index]);
+    }
 
-    // Create buffer for cases when we are inserting new line
-    char line_buffer[MAX_LINE_LEN + 2];
+    return NULL;
+}
 
-    for (int i = 1; i < argc; i++)
+int process_files(Batch *batch, int num_of_threads, int print_stats)
+{
+    /*
+     * Process all files of batch, files are divided between threads (one file is processed by one thread)
+     *
+     * params:
+     * @batch - structure with files and compiled commands
+     * @num_of_threads - number of threads, 0 to process files without threads
+     * @print_stats - flag to print statistics of threads to stderr
+     *
+     * @return - NO_ERROR when all files were processed
+     *         - error code of first file with error
+     */
+
+    double start_time = get_time();
+    int num_of_workers = num_of_threads > 0 ? num_of_threads : 1;
+    if (num_of_workers > batch->num_of_files)
+        num_of_workers = batch->num_of_files;
+
+    int error_flag = NO_ERROR;
+    batch->next_file = 0;
+    batch->results = calloc(batch->num_of_files, sizeof(int));
+    BatchWorker *workers = calloc(num_of_workers, sizeof(BatchWorker));
+    if (batch->results == NULL || workers == NULL)
     {
-        // Perform actions based on operating mode (command from other operating modes will be ignored)
-        switch (operating_mode)
+        fprintf(stderr, "Cant allocate memory for workers\n");
+        error_flag = INPUT_ERROR;
+        num_of_workers = 0;
+    }
+
+    int num_of_ready = 0;
+    for (; num_of_ready < num_of_workers; num_of_ready++)
+    {
+        BatchWorker *worker = &workers[num_of_ready];
+        worker->batch = batch;
+        worker->id = num_of_ready;
+        worker->line = calloc(1, sizeof(Line));
+        worker->reader = calloc(1, sizeof(InputReader));
+        if (worker->line == NULL || worker->reader == NULL || init_output(&worker->output, -1, OUTPUT_BUFFER_SIZE) != NO_ERROR)
         {
-            case TABLE_EDIT:
-                table_edit(line, line_buffer, argc, argv, i);
-                break;
+            free(worker->line);
+            free(worker->reader);
+            break;
+        }
 
-            case DATA_EDIT:
-                data_edit(line, argc, argv, i);
-                break;
+        worker->line->output = &worker->output;
+        worker->line->delim = batch->delim_set->delim;
+        worker->line->delim_set = batch->delim_set;
+    }
 
-            default:
+    if (num_of_workers > 0 && num_of_ready == 0)
+    {
+        fprintf(stderr, "Cant allocate memory for workers\n");
+        error_flag = INPUT_ERROR;
+    }
+
+    // Without threads files are processed by main thread
+    int num_of_started = 0;
+    if (error_flag == NO_ERROR && num_of_threads == 0)
+    {
+        batch_worker(&workers[0]);
+        num_of_started = 1;
+    }
+    else if (error_flag == NO_ERROR)
+    {
+        for (; num_of_started < num_of_ready; num_of_started++)
+        {
+            if (pthread_create(&workers[num_of_started].thread, NULL, batch_worker, &workers[num_of_started]) != 0)
                 break;
         }
 
-        // If there was some memory error return to main
-        if (line->error_flag)
-            return;
-    }
+        // Files are taken by threads that started
+        if (num_of_started == 0)
+        {
+            fprintf(stderr, "Cant start worker threads\n");
+            error_flag = INPUT_ERROR;
+        }
 
-    // Print line from line structure
-    print_line(line);
+        for (int i = 0; i < num_of_started; i++)
+            pthread_join(workers[i].thread, NULL);
+    }
 
-    // Check if there is any line in buffer
-    if (line_buffer[0] != 0)
+    for (int i = 0; error_flag == NO_ERROR && i < batch->num_of_files; i++)
     {
-        // If there is line in buffer copy it to line structure, clear buffer and recursively call this function to process that line
-        strcpy(line->line_string, line_buffer);
-        line_buffer[0] = 0;
-        process_line(line, selector, argc, argv, operating_mode, 0);
+        if (batch->results[i] != NO_ERROR)
+            error_flag = batch->results[i];
     }
 
-    // There will be processed appending of new rows
-    if (line->last_line_flag && !last_line_executed)
+    if (print_stats)
     {
-        if (operating_mode == TABLE_EDIT)
+        double wall_time = get_time() - start_time;
+
+        fprintf(stderr, "Stats: %d files, %d workers, %.3f s\n", batch->num_of_files, num_of_started, wall_time);
+        for (int i = 0; i < num_of_started; i++)
         {
-            for (int i = 1; i < argc; i++)
-            {
-                if (get_table_com_index(argv[i]) == 1)
-                {
-                    // arow
-                    generate_empty_row(line);
-                    print_line(line);
-                }
-            }
+            BatchWorker *worker = &workers[i];
+            fprintf(stderr, "Worker %d: %ld files, %zu bytes, busy %.3f s, utilization %.1f %%\n",
+                    i, worker->num_of_files, worker->processed_bytes, worker->busy_time,
+                    wall_time > 0 ? 100.0 * worker->busy_time / wall_time : 0.0);
         }
     }
+
+    for (int i = 0; i < num_of_ready; i++)
+    {
+        free(workers[i].output.data);
+        free_line(workers[i].line);
+        free(workers[i].line);
+        free(workers[i].reader);
+    }
+
+    free(workers);
+    free(batch->results);
+    batch->results = NULL;
+
+    return error_flag;
 }
 
 int main(int argc, char *argv[])
 {
-    // Check sanity of arguments
+    // Arguments after batch separator are input files, commands and options are only before it
+    int batch_start = get_batch_start(argc, argv);
+    int num_of_args = batch_start < 0 ? argc : batch_start;
+
     int error_flag;
-    if ((error_flag = chck_args(argc, argv)) != NO_ERROR)
-        return error_flag;
+    int num_of_threads = get_number_of_threads(num_of_args, argv);
+    if (num_of_threads < 0)
+        return INPUT_ERROR;
 
-    // Extract delims from args
-    char *delims = get_delims(argv, argc);
+    size_t range_start, range_end;
+    int byte_range = get_byte_range(num_of_args, argv, &range_start, &range_end);
+    int row_offset = get_row_offset(num_of_args, argv);
+    if (byte_range < 0 || row_offset < 0)
+        return INPUT_ERROR;
 
-    // Create buffer strings for line and cell
-    char line[MAX_LINE_LEN + 2];
-    char buffer_line[MAX_LINE_LEN + 2];
+    char *input_path = get_opt(num_of_args, argv, "-f");
+    if (byte_range && input_path == NULL)
+    {
+        fprintf(stderr, "Byte range can be used only with input file (-f)\n");
+        return INPUT_ERROR;
+    }
 
-    if (fgets(buffer_line, (MAX_LINE_LEN + 2), stdin) == NULL)
+    if (batch_start >= 0 && (input_path != NULL || byte_range || row_offset))
     {
-        fprintf(stderr, "Input cant be empty");
+        fprintf(stderr, "Input file (-f), byte range and row offset cant be used with list of files\n");
+        return INPUT_ERROR;
+    }
+
+    // Statistics of columns and groups are collected by one thread from whole input (files of batch have their own)
+    if ((find_argument(num_of_args, argv, "--colstats") >= 0 || find_argument(num_of_args, argv, GROUP_BY_COM) >= 0) &&
+        batch_start < 0 && (num_of_threads > 0 || byte_range))
+    {
+        fprintf(stderr, "Threads (-j) and byte range cant be used with --colstats and groupby\n");
         return INPUT_ERROR;
     }
 
-    // Check operating mode of program based on inputed arguments
-    int operating_mode = get_op_mode(argv, argc);
+    // Extract delims from args
+    char *delims = get_delims(argv, num_of_args);
+    DelimSet delim_set;
+    init_delim_set(&delim_set, delims);
+
+    // Open input file from -f argument or stdin, files of batch are opened by its threads
+    static InputReader reader;
+    if (batch_start < 0 && open_input(&reader, input_path) != NO_ERROR)
+        return INPUT_ERROR;
+
+    if (byte_range)
+        set_input_range(&reader, range_start, range_end);
+
+    // Check operating mode of program based on inputed arguments and compile commands for it
+    Program program;
+    if (compile_program(&program, num_of_args, argv) != NO_ERROR)
+    {
+        close_input(&reader);
+        return INPUT_ERROR;
+    }
 
     // Get selector
     Selector selector;
-    get_selector(&selector, argc, argv);
+    if (get_selector(&selector, num_of_args, argv) != NO_ERROR)
+    {
+        free_selector(&selector);
+        free_program(&program);
+        close_input(&reader);
+        return INPUT_ERROR;
+    }
 
-    // Init line hodler
-    Line line_holder;
-    line_holder.delim = delims[0];
-    line_holder.error_flag = NO_ERROR;
+    // Rest of input after selected rows is printed without processing
+    program.first_passed_row = get_first_passed_row(&program, &selector);
 
-    // Iterate over lines
-    while (!line_holder.last_line_flag)
+    int print_stats = has_flag(num_of_args, argv, "--stats");
+
+    if (batch_start >= 0)
+    {
+        Batch batch;
+        batch.files = argv + batch_start + 1;
+        batch.num_of_files = argc - batch_start - 1;
+        batch.program = &program;
+        batch.selector = &selector;
+        batch.delim_set = &delim_set;
+        batch.argc = num_of_args;
+        batch.argv = argv;
+
+        error_flag = process_files(&batch, num_of_threads, print_stats);
+        free_selector(&selector);
+        free_program(&program);
+        return error_flag;
+    }
+
+    // Init output buffer for stdout
+    OutputBuffer output;
+    if (init_output(&output, STDOUT_FILENO, OUTPUT_BUFFER_SIZE) != NO_ERROR)
     {
-        // Copy line from buffer to line holder
-        strcpy(line, buffer_line);
-        // Load new line to buffer
-        line_holder.last_line_flag = fgets(buffer_line, (MAX_LINE_LEN + 2), stdin) == NULL;
+        free_selector(&selector);
+        free_program(&program);
+        close_input(&reader);
+        return OUTPUT_ERROR;
+    }
 
-        // Remove new line character from line
-        rm_newline_chars(line);
-        // Go thru line and replace all delims with one
-        normalize_delims(line, delims);
-        line_holder.line_string = line;
+    // Init line hodler
+    static Line line_holder;
+    line_holder.output = &output;
+    line_holder.delim = delim_set.delim;
+    line_holder.delim_set = &delim_set;
+    line_holder.error_flag = NO_ERROR;
+    line_holder.last_line_flag = 0;
+    line_holder.num_of_cols = -1;
 
-        // Create copy of line
-        strcpy(line_holder.unedited_line_string, line_holder.line_string);
+    // Rows before processed part of input are counted with rows inserted before them
+    line_holder.line_index = advance_line_index(&program, 0, row_offset);
 
-        if (line_holder.line_index == 0)
-            line_holder.num_of_cols = get_number_of_cells(&line_holder);
+    // Reference number of cols of byte range is taken from first line of file, same as when whole file is processed
+    if (byte_range && !is_input_empty(&reader))
+        line_holder.num_of_cols = count_first_line_cells(&line_holder, reader.data, reader.size);
 
-        process_line(&line_holder, &selector, argc, argv, operating_mode, 0);
-        if (line_holder.error_flag)
-            return line_holder.error_flag;
-    }
+    if (num_of_threads > 0)
+        error_flag = process_input_parallel(&reader, &selector, &program, &line_holder, num_of_threads, print_stats);
+    else
+        error_flag = process_input(&reader, &selector, &program, &line_holder, print_stats);
 
-#ifdef DEBUG
-    printf("\n\nDebug:\n");
+    // Statistics and groups are written before line data holding them are freed
+    if (error_flag == NO_ERROR && program.operating_mode == COLUMN_STATS)
+        write_column_stats(&output, &line_holder);
+    else if (error_flag == NO_ERROR && program.operating_mode == GROUP_BY)
+        error_flag = write_groups(&output, &line_holder.groups, &program, line_holder.delim);
 
-    printf("Base cols: %d Final cols: %d\n", line_holder.num_of_cols, line_holder.final_cols);
-    printf("Selector: type %d, a1: %s, a2: %s, str: %s\n", selector.selector_type, selector.a1, selector.a2, selector.str);
-    printf("Delim: '%c'\n", line_holder.delim);
+    free_line(&line_holder);
+    free_selector(&selector);
+    free_program(&program);
+    close_input(&reader);
 
-    printf("Args: ");
-    for (int i = 1; i < argc; i++)
+    // Output of byte range that doesnt end with end of file is continued by output of next range
+    if (error_flag != NO_ERROR || (byte_range && !line_holder.last_line_flag))
     {
-        printf("%s ", argv[i]);
+        // Lines processed before error are still written
+        free_output(&output);
+        return error_flag != NO_ERROR ? error_flag : output.error_flag;
     }
-#endif
 
-    printf("\n");
+    write_output_end(&output, &line_holder, &selector, num_of_args, argv);
 
-    return 0;
-}
\ No newline at end of file
+    free_output(&output);
+    return output.error_flag;
+}